@@ -0,0 +1,393 @@
+
+// Generate a reproducible synthetic input of about the given size in bytes
+string generateBenchmarkInput(int size) {
+    string input;
+    input.reserve(size + 32);
+    unsigned int seed = 12345;
+    while (input.length() < size) {
+        seed = seed * 1103515245 + 12345; // Linear congruential generator
+        unsigned int r = seed >> 8;
+        switch (r % 8) {
+            case 0:
+            case 1:
+            case 2:
+                input += "var" + to_string(r % 50000); // Identifier from a large pool of names
+                break;
+            case 3:
+                input += to_string(r % 100000); // Integer number
+                break;
+            case 4:
+                input += to_string(r % 1000) + "." + to_string(r % 97); // Floating-point number
+                break;
+            case 5:
+                input += to_string(r % 10) + "." + to_string(r % 89) + "e-" + to_string(r % 12); // Scientific notation
+                break;
+            case 6:
+                input += tokenKinds[T_IF + r / 8 % (T_FLOAT - T_IF + 1)]; // Keyword
+                break;
+            default:
+                input += tokenKinds[T_PLUS + r / 8 % (T_ASSIGN - T_PLUS + 1)]; // Operator or punctuation
+        }
+        input += r % 16 == 0 ? '\n' : ' ';
+    }
+    return input;
+}
+
+// Print a table of benchmark results and wait for the user to go back
+void printBenchmarkTable(string title, vector<vector<string>> &data, int width) {
+    int option = 1;
+    while (option) {
+        system("cls");
+        SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 11);
+        cout << "\n\n\n\n\t\t\t\t-------------------------------------------------------------------------------------------------" << endl << endl;
+        cout << "\t\t\t\t[#] " << title << " [#]\n\n";
+
+        int rows = data.size();
+        int cols = data[0].size();
+        cout << "\t\t\t\t " << setfill((char)205) << setw(width*cols+cols-1) << (char)205 << endl;
+        for (int i = 0; i < rows; i++) {
+            cout << "\t\t\t\t";
+            cout << (char)186;
+            for (int j = 0; j < cols; j++) {
+                int padding = (width - data[i][j].length()) / 2;
+                cout << right << setfill(' ') << setw(padding) << ' ';
+                cout << left << setfill(' ') << setw(width - padding) << data[i][j];
+                cout << (char)186;
+            }
+            cout << endl;
+            if (i != rows - 1)
+                cout << "\t\t\t\t " << setfill((char)205) << setw(width*cols+cols-1) << (char)205 << endl;
+        }
+        cout << "\t\t\t\t " << setfill((char)205) << setw(width*cols+cols-1) << (char)205 << endl;
+        cout << "\n\t\t\t\t-------------------------------------------------------------------------------------------------" << endl << endl;
+        cout << "\t\t\t\t[0] Back To Menu" << endl << endl;
+        cout << "\t\t\t\t-------------------------------------------------------------------------------------------------" << endl << endl;
+        cout << "\t\t\t\tPlease enter option : ";
+        cin >> option;
+    }
+}
+
+// Compare tokens per second of the DFA lexer and the reference branch-chain scanner
+void lexerBenchmark() {
+    string input = generateBenchmarkInput(BENCHMARK_INPUT_SIZE);
+    time_point<high_resolution_clock> start;
+    double timeDFA = 0, timeReference = 0;
+    long long tokens = 0;
+
+    for (int i = 0; i < RUN; i++) {
+        SymbolTable table;
+        Lexer lexer(table, input);
+        tokens = 0;
+        tic(start);
+        while (lexer.getNextToken().kind != T_END)
+            tokens++;
+        timeDFA += toc(start);
+    }
+
+    for (int i = 0; i < RUN; i++) {
+        SymbolTable table;
+        Lexer lexer(table, input);
+        tic(start);
+        while (lexer.getNextTokenReference().kind != T_END);
+        timeReference += toc(start);
+    }
+
+    timeDFA /= RUN;
+    timeReference /= RUN;
+    vector<vector<string>> data = {
+            {"Lexer", "Input Size (bytes)", "Tokens", "Time (ms)", "Tokens / Second"},
+            {"DFA + " + simdKernel + " Kernels", to_string(input.length()), to_string(tokens), to_string(timeDFA / 1e6), to_string((long long)(tokens / (timeDFA / 1e9)))},
+            {"Branch-Chain Scanner", to_string(input.length()), to_string(tokens), to_string(timeReference / 1e6), to_string((long long)(tokens / (timeReference / 1e9)))}
+    };
+    printBenchmarkTable("Lexer Benchmark", data, 24);
+}
+
+// Lex a memory-mapped source file in place and report its tokens, lexical errors and throughput
+void fileLexerBenchmark(MappedFile *file) {
+    time_point<high_resolution_clock> start;
+    string path = file->path;
+    long long size = file->length;
+    long long tokens = 0, lexicalErrors = 0;
+    string firstError = "N/A"; // Line and column of the first lexical error
+
+    SymbolTable table;
+    Lexer lexer(table, file);
+    tic(start);
+    for (Token token = lexer.getNextToken(); token.kind != T_END; token = lexer.getNextToken()) {
+        tokens++;
+        if (token.kind >= T_INVALID_CHAR && lexicalErrors++ == 0) {
+            SourcePosition at = lexer.position(token.start);
+            firstError = to_string(at.line) + ":" + to_string(at.column);
+        }
+    }
+    double timeFile = toc(start);
+
+    vector<vector<string>> data = {
+            {"File", "Size (bytes)", "Tokens", "Lexical Errors", "First Error (Line:Col)", "Time (ms)", "Tokens / Second"},
+            {path, to_string(size), to_string(tokens), to_string(lexicalErrors), firstError, to_string(timeFile / 1e6), to_string((long long)(tokens / (timeFile / 1e9)))}
+    };
+    printBenchmarkTable("Memory-Mapped File Lexer", data, 20);
+}
+
+// Time tokenizeParallel on a large input with 1, 2, 4, ... threads up to the number of cores
+void lexerScalingBenchmark() {
+    string input = generateBenchmarkInput(BENCHMARK_INPUT_SIZE);
+    int cores = max(1u, thread::hardware_concurrency());
+    vector<int> threadCounts;
+    for (int threads = 1; threads < cores; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(cores);
+
+    vector<vector<string>> data = {{"Threads", "Tokens", "Time (ms)", "Tokens / Second", "Speedup"}};
+    time_point<high_resolution_clock> start;
+    double timeOneThread = 0;
+    for (int threads : threadCounts) {
+        double timeThreads = 0;
+        long long tokens = 0;
+        for (int i = 0; i < RUN; i++) {
+            SymbolTable table;
+            Lexer lexer(table, input);
+            TokenBuffer buffer;
+            tic(start);
+            lexer.tokenizeParallel(buffer, threads);
+            timeThreads += toc(start);
+            tokens = buffer.size;
+        }
+        timeThreads /= RUN;
+        if (threads == 1)
+            timeOneThread = timeThreads;
+        data.push_back({to_string(threads), to_string(tokens), to_string(timeThreads / 1e6), to_string((long long)(tokens / (timeThreads / 1e9))), to_string(timeOneThread / timeThreads) + "x"});
+    }
+    printBenchmarkTable("Parallel Lexer Scaling", data, 24);
+}
+
+// Time RUN small edits of a large input relexed incrementally and relexed from scratch
+void incrementalLexerBenchmark() {
+    string input = generateBenchmarkInput(BENCHMARK_INPUT_SIZE);
+    SymbolTable table;
+    Lexer lexer(table, input);
+    TokenBuffer tokens;
+    lexer.tokenizeAll(tokens);
+
+    time_point<high_resolution_clock> start;
+    double timeIncremental = 0, timeFull = 0;
+    long long relexed = 0; // Tokens lexed again by the incremental lexer over all edits
+    unsigned int seed = 54321;
+    for (int i = 0; i < RUN; i++) {
+        // Replace a few bytes at a reproducible position with an identifier, as a keystroke burst would
+        seed = seed * 1103515245 + 12345;
+        long long offset = (seed >> 8) % input.length();
+        string inserted = " var" + to_string(i) + " ";
+        input.replace(offset, 2, inserted);
+
+        tic(start);
+        TokenEdit edit = lexer.applyEdit(tokens, offset, 2, inserted);
+        timeIncremental += toc(start);
+        relexed += edit.inserted;
+
+        tic(start);
+        SymbolTable fullTable;
+        Lexer fullLexer(fullTable, input);
+        TokenBuffer fullTokens;
+        fullLexer.tokenizeAll(fullTokens);
+        timeFull += toc(start);
+    }
+
+    vector<vector<string>> data = {
+            {"Lexer", "Edits", "Tokens Lexed / Edit", "Time / Edit (ms)"},
+            {"Incremental", to_string(RUN), to_string(relexed / RUN), to_string(timeIncremental / RUN / 1e6)},
+            {"Full Re-Lex", to_string(RUN), to_string(tokens.size), to_string(timeFull / RUN / 1e6)}
+    };
+    printBenchmarkTable("Incremental Lexer Benchmark", data, 24);
+}
+
+// Time reading a generated grammar file of BENCHMARK_GRAMMAR_SIZE productions, with many non-terminals and long lines
+void grammarReaderBenchmark() {
+    // Write the grammar in the layouts the reader accepts: comments, continuation lines and mixed whitespace
+    string text = "// Generated grammar for the grammar reader benchmark\n";
+    for (int i = 0; 3 * i < BENCHMARK_GRAMMAR_SIZE; i++) {
+        string name = "N" + to_string(i);
+        text += name + " -> " + name + " + N" + to_string(i + 1) + " * id\t| ( N" + to_string(i / 2) + " ) \\\n";
+        text += "        intNum // Third alternative on its own line\n";
+        text += "    | floatNum\n";
+    }
+    ofstream(BENCHMARK_GRAMMAR_FILE, ios::binary) << text;
+
+    time_point<high_resolution_clock> start;
+    double timeRead = 0;
+    int productions = 0, symbols = 0;
+    for (int i = 0; i < RUN; i++) {
+        Grammar grammar;
+        tic(start);
+        grammar.read(BENCHMARK_GRAMMAR_FILE);
+        timeRead += toc(start);
+        productions = grammar.size();
+        symbols = grammar.names.size();
+    }
+    timeRead /= RUN;
+
+    vector<vector<string>> data = {
+            {"Size (bytes)", "Productions", "Symbols", "Time (ms)", "Productions / Second"},
+            {to_string(text.length()), to_string(productions), to_string(symbols), to_string(timeRead / 1e6), to_string((long long)(productions / (timeRead / 1e9)))}
+    };
+    printBenchmarkTable("Grammar Reader Benchmark", data, 24);
+}
+
+// Grammar of the given number of non-terminals that are mutually recursive, left-recursive and mostly nullable
+Grammar generateBenchmarkGrammar(int nonTerminals) {
+    string text;
+    for (int i = 0; i < nonTerminals; i++) {
+        string name = "N" + to_string(i), next = "N" + to_string((i + 1) % nonTerminals);
+        text += name + " -> " + next + " t" + to_string(i % 200) + " N" + to_string((i * 7) % nonTerminals) + "\n";
+        text += "    | N" + to_string(i / 2) + " " + next + "\n";
+        text += "    | " + name + " t" + to_string((i + 100) % 200) + "\n";
+        if (i % 3 != 0)
+            text += "    | e\n";
+    }
+    Grammar grammar;
+    grammar.read(text.data(), text.length());
+    grammar.finish();
+    return grammar;
+}
+
+// Time the FIRST and FOLLOW sets of generated grammars doubling up to BENCHMARK_NONTERMINALS non-terminals
+void grammarSetsBenchmark() {
+    vector<vector<string>> data = {{"Non-Terminals", "Productions", "Terminals", "FIRST (ms)", "FOLLOW (ms)"}};
+    for (int nonTerminals = BENCHMARK_NONTERMINALS / 8; nonTerminals <= BENCHMARK_NONTERMINALS; nonTerminals *= 2) {
+        Grammar grammar = generateBenchmarkGrammar(nonTerminals);
+        time_point<high_resolution_clock> start;
+        double timeFirst = 0, timeFollow = 0;
+        for (int i = 0; i < RUN; i++) {
+            GrammarSets sets(grammar);
+            tic(start);
+            sets.findFirsts();
+            timeFirst += toc(start);
+            tic(start);
+            sets.findFollows();
+            timeFollow += toc(start);
+        }
+        data.push_back({to_string(nonTerminals), to_string(grammar.size()), to_string(grammar.terminals.size()), to_string(timeFirst / RUN / 1e6), to_string(timeFollow / RUN / 1e6)});
+    }
+    printBenchmarkTable("FIRST / FOLLOW Benchmark", data, 24);
+}
+
+// Average parse time of a parser session over RUN runs of a compiled grammar, with the tokens replayed from a buffer if one is given
+// and every step logged into the processing table if trace is set
+template <typename Parser, typename Compiled>
+double averageParseTime(const Compiled &compiled, string input, TokenBuffer *replay, double &parseTime, bool trace = false) {
+    double total = 0;
+    Parser *parser = NULL;
+    for (int i = 0; i < RUN; i++) {
+        SymbolTable table;
+        Lexer lexer(table, input);
+        if (replay != NULL)
+            lexer.replayTokens(replay);
+        if (parser == NULL)
+            parser = new Parser(compiled, lexer, trace);
+        else
+            parser->reset(lexer);
+        parser->parse();
+        total += parseTime;
+    }
+    delete parser;
+    return total / RUN;
+}
+
+// Compare the parse time of every parser with live lexing and with a saved token buffer replayed instead
+void parseReplayBenchmark(string input, string grammar) {
+    // Compile the grammar once for every parser
+    RecursiveDescentGrammar rd(grammar);
+    LL1Grammar ll1(grammar);
+    LR1Grammar lr1(grammar);
+    LALR1Grammar lalr1(grammar);
+
+    // Tokenize the input once and save it, then load it back as a later run would
+    TokenBuffer tokens, replay;
+    SymbolTable table;
+    Lexer lexer(table, input);
+    lexer.useTerminals(rd.spec); // Save the tokens with the kinds of the grammar's terminals
+    lexer.tokenizeAll(tokens);
+    tokens.save(TOKEN_BUFFER_FILE);
+    replay.load(TOKEN_BUFFER_FILE);
+
+    double saved[4] = {TimeRD, TimeLL1, TimeLR1, TimeLALR1}; // Parsing times shown in the main menu
+    string names[4] = {"Recursive Descent", "LL(1)", "LR(1)", "LALR(1)"};
+    double live[4], replayed[4];
+    live[0] = averageParseTime<RecursiveDescentParser>(rd, input, NULL, TimeRD);
+    replayed[0] = averageParseTime<RecursiveDescentParser>(rd, input, &replay, TimeRD);
+    live[1] = averageParseTime<LL1Parser>(ll1, input, NULL, TimeLL1);
+    replayed[1] = averageParseTime<LL1Parser>(ll1, input, &replay, TimeLL1);
+    live[2] = averageParseTime<LR1Parser>(lr1, input, NULL, TimeLR1);
+    replayed[2] = averageParseTime<LR1Parser>(lr1, input, &replay, TimeLR1);
+    live[3] = averageParseTime<LALR1Parser>(lalr1, input, NULL, TimeLALR1);
+    replayed[3] = averageParseTime<LALR1Parser>(lalr1, input, &replay, TimeLALR1);
+    TimeRD = saved[0];
+    TimeLL1 = saved[1];
+    TimeLR1 = saved[2];
+    TimeLALR1 = saved[3];
+
+    vector<vector<string>> data = {{"Parser", "Tokens", "Live Lexer (ns)", "Replayed Tokens (ns)"}};
+    for (int i = 0; i < 4; i++)
+        data.push_back({names[i], to_string(replay.size), to_string(live[i]), to_string(replayed[i])});
+    printBenchmarkTable("Parse Phase Benchmark", data, 24);
+}
+
+// Compare the parse time of every parser with its processing table traced and with the trace-free fast mode
+void parseTraceBenchmark(string input, string grammar) {
+    // Compile the grammar once for every parser
+    RecursiveDescentGrammar rd(grammar);
+    LL1Grammar ll1(grammar);
+    LR1Grammar lr1(grammar);
+    LALR1Grammar lalr1(grammar);
+
+    // Count the tokens of the input with the grammar's terminals
+    TokenBuffer tokens;
+    SymbolTable table;
+    Lexer lexer(table, input);
+    lexer.useTerminals(rd.spec);
+    lexer.tokenizeAll(tokens, false);
+
+    double saved[4] = {TimeRD, TimeLL1, TimeLR1, TimeLALR1}; // Parsing times shown in the main menu
+    string names[4] = {"Recursive Descent", "LL(1)", "LR(1)", "LALR(1)"};
+    double traced[4], fast[4];
+    traced[0] = averageParseTime<RecursiveDescentParser>(rd, input, NULL, TimeRD, true);
+    fast[0] = averageParseTime<RecursiveDescentParser>(rd, input, NULL, TimeRD);
+    traced[1] = averageParseTime<LL1Parser>(ll1, input, NULL, TimeLL1, true);
+    fast[1] = averageParseTime<LL1Parser>(ll1, input, NULL, TimeLL1);
+    traced[2] = averageParseTime<LR1Parser>(lr1, input, NULL, TimeLR1, true);
+    fast[2] = averageParseTime<LR1Parser>(lr1, input, NULL, TimeLR1);
+    traced[3] = averageParseTime<LALR1Parser>(lalr1, input, NULL, TimeLALR1, true);
+    fast[3] = averageParseTime<LALR1Parser>(lalr1, input, NULL, TimeLALR1);
+    TimeRD = saved[0];
+    TimeLL1 = saved[1];
+    TimeLR1 = saved[2];
+    TimeLALR1 = saved[3];
+
+    vector<vector<string>> data = {{"Parser", "Tokens", "Traced (ns)", "Trace-Free (ns)", "Speedup"}};
+    for (int i = 0; i < 4; i++)
+        data.push_back({names[i], to_string(tokens.size), to_string(traced[i]), to_string(fast[i]), to_string(fast[i] > 0 ? traced[i] / fast[i] : 0)});
+    printBenchmarkTable("Traced vs Trace-Free Parse Benchmark", data, 20);
+}
+
+// Display the menu of benchmarks
+int BenchmarkMenu() {
+    system("cls");
+    int option;
+    SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 7);
+    cout << "\n\n\n\n\t\t\t\t------------------------------------------------------------------------" << endl << endl;
+    cout << "\t\t\t\t[+] Benchmarks [+]" << endl << endl;
+    cout << "\t\t\t\t------------------------------------------------------------------------" << endl << endl;
+    cout << "\t\t\t\t[1] Lexer: Table-Driven DFA vs Branch-Chain Scanner" << endl << endl;
+    cout << "\t\t\t\t[2] Lexer: Memory-Mapped Source File" << endl << endl;
+    cout << "\t\t\t\t[3] Parsers: Live Lexer vs Replayed Token Buffer" << endl << endl;
+    cout << "\t\t\t\t[4] Lexer: Parallel Scaling from 1 to N Threads" << endl << endl;
+    cout << "\t\t\t\t[5] Lexer: Incremental Re-Lexing vs Full Re-Lex" << endl << endl;
+    cout << "\t\t\t\t[6] Grammar: Reading a Large Generated Grammar File" << endl << endl;
+    cout << "\t\t\t\t[7] Grammar: FIRST / FOLLOW Sets of Thousands of Non-Terminals" << endl << endl;
+    cout << "\t\t\t\t[8] Parsers: Traced vs Trace-Free Parsing" << endl << endl;
+    cout << "\t\t\t\t[0] Back to Main Menu" << endl << endl;
+    cout << "\t\t\t\t------------------------------------------------------------------------" << endl << endl;
+    cout << "\t\t\t\tPlease enter option : ";
+    cin >> option;
+    return option;
+}
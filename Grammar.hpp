@@ -0,0 +1,546 @@
+
+// Grammar shared by every parser, with its symbols interned to dense integer ids.
+// Each production keeps the id of its LHS and its RHS as a contiguous span of ids in rhs, an
+// empty span standing for the empty string "e". Once finish has run, ids follow the alphabetical
+// order of the names, so a set of ids is ordered like the set of names it replaces.
+struct Grammar {
+    vector<string> names; // Name of every symbol, indexed by its id
+    unordered_map<string, int> ids; // Id of every symbol name
+    vector<bool> nonTerminal; // Whether each symbol is a non-terminal
+    int epsilon; // Id of the empty string "e"
+    int endMarker; // Id of the end of input marker "$"
+    int start; // Id of the start symbol
+    vector<int> lhs; // Left-hand side of every production
+    vector<int> rhsBegin; // Start of the right-hand side of every production in rhs
+    vector<int> rhsEnd; // End of the right-hand side of every production in rhs
+    vector<int> rhs; // Symbols of the right-hand sides, one contiguous span per production
+    vector<int> terminals; // Terminals including "$", in the order of their ids
+    vector<int> nonterminals; // Non-terminals in the order of their ids
+    vector<int> position; // Position of every symbol in terminals or nonterminals
+    vector<int> lhsBegin; // Start of the productions of every symbol in byLhs, with one more entry for the end
+    vector<int> byLhs; // Productions grouped by their LHS, each group in production order
+    vector<int> kindSymbols; // Terminal of every token kind, -1 for kinds the grammar does not declare
+    vector<string> errors; // Syntax errors found while reading the grammar file
+
+    // Constructor to create an empty grammar with the empty string and the end of input marker
+    Grammar() : start(-1) {
+        epsilon = intern("e");
+        endMarker = intern("$");
+    }
+
+    // Id of a symbol name, interning it if it is new
+    int intern(const string &name, bool isNonTerminal = false) {
+        auto it = ids.find(name);
+        int id;
+        if (it != ids.end()) {
+            id = it->second;
+        } else {
+            id = names.size();
+            names.push_back(name);
+            nonTerminal.push_back(false);
+            ids[name] = id;
+        }
+        if (isNonTerminal)
+            nonTerminal[id] = true;
+        return id;
+    }
+
+    // Number of productions
+    int size() const {
+        return lhs.size();
+    }
+
+    // Number of symbols on the right-hand side of a production
+    int length(int p) const {
+        return rhsEnd[p] - rhsBegin[p];
+    }
+
+    // First symbol of the right-hand side of a production
+    const int *begin(int p) const {
+        return rhs.data() + rhsBegin[p];
+    }
+
+    // One past the last symbol of the right-hand side of a production
+    const int *end(int p) const {
+        return rhs.data() + rhsEnd[p];
+    }
+
+    // Copy of the right-hand side of a production
+    vector<int> symbols(int p) const {
+        return vector<int>(begin(p), end(p));
+    }
+
+    // Check if two productions have the same right-hand side
+    bool sameRhs(int p, int q) const {
+        return length(p) == length(q) && equal(begin(p), end(p), begin(q));
+    }
+
+    // First production with the same LHS and right-hand side as a production
+    int firstCopy(int p) const {
+        for (int i = lhsBegin[lhs[p]]; ; i++)
+            if (sameRhs(byLhs[i], p))
+                return byLhs[i];
+    }
+
+    // Replace a production with a new LHS and right-hand side
+    void replace(int p, int left, const vector<int> &right) {
+        lhs[p] = left;
+        rhsBegin[p] = rhs.size();
+        rhs.insert(rhs.end(), right.begin(), right.end());
+        rhsEnd[p] = rhs.size();
+        nonTerminal[left] = true;
+    }
+
+    // Insert a production before the production at index at
+    void insert(int at, int left, const vector<int> &right) {
+        lhs.insert(lhs.begin() + at, left);
+        rhsBegin.insert(rhsBegin.begin() + at, 0);
+        rhsEnd.insert(rhsEnd.begin() + at, 0);
+        replace(at, left, right);
+    }
+
+    // Append a production
+    void add(int left, const vector<int> &right) {
+        insert(size(), left, right);
+    }
+
+    // Remove a production
+    void erase(int p) {
+        lhs.erase(lhs.begin() + p);
+        rhsBegin.erase(rhsBegin.begin() + p);
+        rhsEnd.erase(rhsEnd.begin() + p);
+    }
+
+    // Read the productions of a grammar file through a read-only mapping; false if it cannot be read or has syntax errors
+    bool read(const string &path) {
+        MappedFile file(path);
+        if (!file.isOpen()) {
+            errors.push_back("Grammar Error: Cannot open the grammar file '" + path + "'.");
+            return false;
+        }
+        return read(file.data, file.length);
+    }
+
+    // Read the productions of a grammar text in a single pass; false if it has syntax errors, leaving an empty grammar.
+    // A rule is "A -> x y | z" with its symbols separated by any whitespace, and "e" or an empty alternative is the empty
+    // string. A line starting with "|", or following a line that ends with "\", continues the rule above it, and a
+    // symbol starting with "//" comments out the rest of its line.
+    bool read(const char *text, long long length) {
+        vector<int> seen(1024, -1); // Open-addressing index of the ids of the symbols read so far, -1 for empty slots
+        int seenCount = 0; // Number of symbols in seen
+        vector<string_view> words; // Symbols of the current line
+        const char *stop = text + length;
+        long long line = 0;
+        int left = -1; // LHS of the rule being read, -1 before the first rule
+        vector<int> right; // Right-hand side of the alternative being read
+        bool continued = false; // Whether the previous line ended with "\"
+        bool skipping = false; // Whether the lines of a rule with a syntax error are being skipped
+
+        // Id of a symbol of the text, interning it if it is new; seen is hashed like the symbol table to skip building strings
+        auto symbol = [&](string_view word) {
+            int mask = seen.size() - 1;
+            int slot = SymbolTable::hash(word) & mask;
+            while (seen[slot] != -1 && names[seen[slot]] != word)
+                slot = (slot + 1) & mask;
+            if (seen[slot] != -1)
+                return seen[slot];
+            int id = intern(string(word));
+            seen[slot] = id;
+            if (2 * ++seenCount > seen.size()) {
+                // Double the index and insert the symbols again
+                vector<int> old(seen.size() * 2, -1);
+                old.swap(seen);
+                mask = seen.size() - 1;
+                for (int known : old) {
+                    if (known == -1)
+                        continue;
+                    slot = SymbolTable::hash(names[known]) & mask;
+                    while (seen[slot] != -1)
+                        slot = (slot + 1) & mask;
+                    seen[slot] = known;
+                }
+            }
+            return id;
+        };
+
+        for (const char *p = text; p < stop; ) {
+            const char *lineStart = p;
+            const char *lineEnd = (const char *)memchr(p, '\n', stop - p);
+            if (lineEnd == NULL)
+                lineEnd = stop;
+            p = lineEnd + 1;
+            line++;
+
+            // Split the line into symbols at any whitespace, up to a comment
+            words.clear();
+            for (const char *q = lineStart; q < lineEnd; ) {
+                if (*q == ' ' || *q == '\t' || *q == '\r' || *q == '\v' || *q == '\f') {
+                    q++;
+                    continue;
+                }
+                const char *wordStart = q;
+                while (q < lineEnd && *q != ' ' && *q != '\t' && *q != '\r' && *q != '\v' && *q != '\f')
+                    q++;
+                string_view word(wordStart, q - wordStart);
+                if (word.substr(0, 2) == "//")
+                    break;
+                words.push_back(word);
+            }
+
+            // Error message with the line and column of a symbol
+            auto error = [&](const string &message, string_view at) {
+                errors.push_back("Grammar Error: " + message + " Line number: [" + to_string(line) + "], Column number: [" + to_string(at.data() - lineStart + 1) + "]");
+            };
+
+            bool continuation = continued || (!words.empty() && words[0] == "|");
+            continued = !words.empty() && words.back() == "\\";
+            if (continued)
+                words.pop_back();
+            if (words.empty())
+                continue;
+
+            size_t first = 0; // First symbol of the right-hand side on this line
+            if (continuation) {
+                if (skipping)
+                    continue;
+                if (left == -1) {
+                    error("'" + string(words[0]) + "' continues no rule.", words[0]);
+                    skipping = true;
+                    continue;
+                }
+            } else {
+                if (left != -1)
+                    add(left, right); // Close the last alternative of the rule above
+                left = -1;
+                right.clear();
+                skipping = true;
+                if (words[0] == "->") {
+                    error("Missing left-hand side before '->'.", words[0]);
+                    continue;
+                }
+                if (words.size() < 2 || words[1] != "->") {
+                    error("Expected '->' after '" + string(words[0]) + "'.", words.size() < 2 ? words[0] : words[1]);
+                    continue;
+                }
+                if (words[0] == "e" || words[0] == "$" || words[0] == "|") {
+                    error("'" + string(words[0]) + "' cannot be the left-hand side of a rule.", words[0]);
+                    continue;
+                }
+                left = symbol(words[0]);
+                nonTerminal[left] = true;
+                skipping = false;
+                first = 2;
+            }
+
+            // Split the right-hand side into symbols, starting a new production at every "|"
+            for (size_t i = first; i < words.size(); i++) {
+                string_view word = words[i];
+                if (word == "|") {
+                    add(left, right);
+                    right.clear();
+                } else if (word == "->") {
+                    error("Unexpected '->' in the right-hand side of '" + names[left] + "'.", word);
+                } else if (word != "e") {
+                    right.push_back(symbol(word));
+                }
+            }
+        }
+        if (left != -1)
+            add(left, right); // Add the last production
+
+        if (errors.empty() && size() == 0)
+            errors.push_back("Grammar Error: The grammar has no productions.");
+        if (!errors.empty()) {
+            // Leave an empty grammar holding only the errors, so nothing reads a half-built grammar
+            vector<string> found;
+            found.swap(errors);
+            *this = Grammar();
+            errors.swap(found);
+            return false;
+        }
+        start = lhs[0]; // Set the starting symbol from the first production
+        return true;
+    }
+
+    // Write the symbols and productions to a cache
+    void save(CacheWriter &out) const {
+        out.put(names);
+        out.put(nonTerminal);
+        out.put(epsilon);
+        out.put(endMarker);
+        out.put(start);
+        out.put(lhs);
+        out.put(rhsBegin);
+        out.put(rhsEnd);
+        out.put(rhs);
+    }
+
+    // Read the symbols and productions written by save and index them; false if the cache is too short or corrupted
+    bool load(CacheReader &in) {
+        in.get(names);
+        in.get(nonTerminal);
+        in.get(epsilon);
+        in.get(endMarker);
+        in.get(start);
+        in.get(lhs);
+        in.get(rhsBegin);
+        in.get(rhsEnd);
+        in.get(rhs);
+
+        // Check every id and span against the symbol and production counts before indexing with them
+        int count = names.size();
+        in.check(nonTerminal.size() == count && rhsBegin.size() == lhs.size() && rhsEnd.size() == lhs.size());
+        in.inRange(epsilon, 0, count);
+        in.inRange(endMarker, 0, count);
+        in.inRange(start, lhs.empty() ? -1 : 0, count);
+        in.inRange(lhs, 0, count);
+        in.inRange(rhs, 0, count);
+        for (int p = 0; p < lhs.size() && in.ok; p++)
+            in.check(rhsBegin[p] >= 0 && rhsBegin[p] <= rhsEnd[p] && rhsEnd[p] <= rhs.size());
+        if (!in.ok)
+            return false;
+        ids.clear();
+        for (int i = 0; i < names.size(); i++)
+            ids[names[i]] = i;
+        index();
+        return true;
+    }
+
+    // Add the production S' -> S of the augmented grammar in front of the others and make S' the start symbol
+    void augment() {
+        int original = lhs[0];
+        start = intern(names[original] + "'", true);
+        insert(0, start, {original});
+    }
+
+    // Renumber the symbols in the order of their names and index the terminals, non-terminals and productions
+    void finish() {
+        int count = names.size();
+        vector<int> order(count); // Old ids in the order of their names
+        for (int i = 0; i < count; i++)
+            order[i] = i;
+        sort(order.begin(), order.end(), [&](int a, int b) { return names[a] < names[b]; });
+
+        vector<int> renumbered(count); // New id of every old id
+        vector<string> sortedNames(count);
+        vector<bool> sortedNonTerminal(count);
+        for (int i = 0; i < count; i++) {
+            renumbered[order[i]] = i;
+            sortedNames[i] = names[order[i]];
+            sortedNonTerminal[i] = nonTerminal[order[i]];
+        }
+        names.swap(sortedNames);
+        nonTerminal.swap(sortedNonTerminal);
+        for (int i = 0; i < count; i++)
+            ids[names[i]] = i;
+        for (int &symbol : lhs)
+            symbol = renumbered[symbol];
+        for (int &symbol : rhs)
+            symbol = renumbered[symbol];
+        epsilon = renumbered[epsilon];
+        endMarker = renumbered[endMarker];
+        if (start >= 0)
+            start = renumbered[start];
+        index();
+    }
+
+    // Index the terminals, non-terminals and productions of a grammar whose ids follow the order of their names
+    void index() {
+        int count = names.size();
+
+        // Split the symbols into terminals and non-terminals
+        terminals.clear();
+        nonterminals.clear();
+        position.assign(count, -1);
+        for (int i = 0; i < count; i++) {
+            if (nonTerminal[i]) {
+                position[i] = nonterminals.size();
+                nonterminals.push_back(i);
+            } else if (i != epsilon) {
+                position[i] = terminals.size();
+                terminals.push_back(i);
+            }
+        }
+
+        // Group the productions by their LHS
+        lhsBegin.assign(count + 1, 0);
+        for (int p = 0; p < size(); p++)
+            lhsBegin[lhs[p] + 1]++;
+        for (int i = 0; i < count; i++)
+            lhsBegin[i + 1] += lhsBegin[i];
+        byLhs.resize(size());
+        vector<int> next(lhsBegin.begin(), lhsBegin.end() - 1);
+        for (int p = 0; p < size(); p++)
+            byLhs[next[lhs[p]]++] = p;
+
+        // Map the token kinds of the terminals back to them
+        kindSymbols.assign(MAX_TOKEN_KINDS, -1);
+        for (int terminal : terminals) {
+            short kind = tokenKindOf(names[terminal]);
+            if (kind >= 0)
+                kindSymbols[kind] = terminal;
+        }
+    }
+
+    // Names of the terminals, as the lexer takes them
+    set<string> terminalNames() const {
+        set<string> result;
+        for (int terminal : terminals)
+            result.insert(names[terminal]);
+        return result;
+    }
+
+    // Right-hand side of a production as text, with a dot before the symbol at index dot when dot is not -1
+    string text(int p, int dot = -1) const {
+        string result;
+        for (int i = 0; i <= length(p); i++) {
+            if (i == dot)
+                result += result.empty() ? "." : " .";
+            if (i < length(p))
+                result += (result.empty() ? "" : " ") + names[rhs[rhsBegin[p] + i]];
+        }
+        if (result.empty())
+            result = "e";
+        return result;
+    }
+
+    // Names of a set of symbols joined by a separator
+    string list(const set<int> &symbols, const string &separator) const {
+        string result;
+        for (auto it = symbols.begin(); it != symbols.end(); it++) {
+            result += names[*it];
+            if (next(it) != symbols.end())
+                result += separator;
+        }
+        return result;
+    }
+
+    // Number of leading symbols two symbol strings share
+    static int commonPrefix(const vector<int> &a, const vector<int> &b) {
+        int length = 0;
+        while (length < a.size() && length < b.size() && a[length] == b[length])
+            length++;
+        return length;
+    }
+
+    // Eliminate left recursion from the grammar
+    void eliminateLeftRecursion() {
+        vector<int> arrangement; // Non-terminals in the order they first appear as an LHS
+        for (int p = 0; p < size(); p++)
+            if (find(arrangement.begin(), arrangement.end(), lhs[p]) == arrangement.end())
+                arrangement.push_back(lhs[p]);
+
+        for (int i = 0; i < arrangement.size(); i++) {
+            // Replace indirect left recursion through the non-terminals arranged before this one
+            for (int j = 0; j < i; j++) {
+                for (int k = 0; k < size(); k++) {
+                    if (lhs[k] != arrangement[i] || length(k) == 0 || *begin(k) != arrangement[j])
+                        continue;
+                    int left = lhs[k];
+                    vector<int> rest(begin(k) + 1, end(k)); // Symbols after the replaced non-terminal
+                    bool first = true;
+                    for (int l = 0; l < size(); l++) {
+                        if (lhs[l] != arrangement[j])
+                            continue;
+                        vector<int> right = symbols(l);
+                        right.insert(right.end(), rest.begin(), rest.end());
+                        if (first) {
+                            replace(k, left, right);
+                            first = false;
+                        } else {
+                            insert(k, left, right);
+                        }
+                    }
+                }
+            }
+
+            // Detect direct left recursion
+            bool recursive = false;
+            for (int p = 0; p < size() && !recursive; p++)
+                recursive = lhs[p] == arrangement[i] && length(p) > 0 && *begin(p) == arrangement[i];
+            if (!recursive)
+                continue;
+
+            // Move the left-recursive productions to a new non-terminal that ends every production
+            int tail = intern(names[arrangement[i]] + "'", true);
+            int last = 0;
+            for (int p = 0; p < size(); p++) {
+                if (lhs[p] != arrangement[i])
+                    continue;
+                last = p;
+                vector<int> right = symbols(p);
+                if (!right.empty() && right[0] == arrangement[i]) {
+                    right.erase(right.begin());
+                    right.push_back(tail);
+                    replace(p, tail, right);
+                } else {
+                    right.push_back(tail);
+                    replace(p, lhs[p], right);
+                }
+            }
+            insert(last + 1, tail, {}); // Add epsilon production for the new non-terminal
+        }
+    }
+
+    // Apply left factoring to the grammar
+    void leftFactoring() {
+        // Non-terminals in the order of their names, including the ones added while factoring
+        set<string> pending;
+        for (int i = 0; i < names.size(); i++)
+            if (nonTerminal[i])
+                pending.insert(names[i]);
+
+        for (auto i = pending.begin(); i != pending.end(); i++) {
+            int left = ids[*i];
+
+            // Collect the distinct alternatives of the non-terminal in the order of their names
+            vector<vector<int>> alternatives;
+            for (int p = 0; p < size(); p++)
+                if (lhs[p] == left)
+                    alternatives.push_back(symbols(p));
+            sort(alternatives.begin(), alternatives.end(), [&](const vector<int> &a, const vector<int> &b) {
+                return lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [&](int x, int y) { return names[x] < names[y]; });
+            });
+            alternatives.erase(unique(alternatives.begin(), alternatives.end()), alternatives.end());
+
+            // Group alternatives that share a prefix with the first alternative of a group
+            vector<vector<vector<int>>> groups;
+            for (auto &alternative : alternatives) {
+                bool added = false;
+                for (auto &group : groups) {
+                    if (commonPrefix(group[0], alternative) > 0) {
+                        group.push_back(alternative);
+                        added = true;
+                        break;
+                    }
+                }
+                if (!added)
+                    groups.push_back({alternative});
+            }
+
+            // Factor out the common prefix of every group with more than one alternative
+            for (auto &group : groups) {
+                if (group.size() < 2)
+                    continue;
+                int prefix = group[0].size();
+                for (int g = 1; g < group.size(); g++)
+                    prefix = min(prefix, commonPrefix(group[0], group[g]));
+
+                string name = *i + "^";
+                int factored = intern(name, true);
+                pending.insert(name);
+                vector<int> right(group[0].begin(), group[0].begin() + prefix);
+                right.push_back(factored);
+                add(left, right);
+
+                // Replace the original productions with the rest of each alternative
+                for (auto &alternative : group) {
+                    for (int p = 0; p < size(); p++)
+                        if (lhs[p] == left && length(p) == alternative.size() && equal(begin(p), end(p), alternative.begin()))
+                            erase(p);
+                    add(factored, vector<int>(alternative.begin() + prefix, alternative.end()));
+                }
+            }
+        }
+    }
+};
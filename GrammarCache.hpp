@@ -0,0 +1,261 @@
+
+// Binary cache of the artifacts a parser compiles from a grammar file, so later runs map them in instead of computing
+// them again. A cache file starts with a header holding the format version, the parser kind, a content hash of the
+// grammar file, the size of the cache and a content hash of the artifacts; a cache whose header does not match is stale
+// or corrupted and gets rebuilt. Every id read back is also checked against the counts read before it, so a cache that
+// passes the header but holds ids out of range is rebuilt too instead of indexing out of bounds.
+
+// 64-bit FNV-1a hash of a block of bytes
+unsigned long long contentHash(const char *data, long long length) {
+    unsigned long long h = 14695981039346656037ull;
+    for (long long i = 0; i < length; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Path of the cache holding what a parser kind compiles from a grammar file
+string cachePath(const string &grammar, const string &kind) {
+    return grammar + "." + kind + ".cache";
+}
+
+// artifacts encoded into a byte buffer that is written to a cache file in one go
+struct CacheWriter {
+    string bytes; // Header and encoded artifacts
+    size_t sizeAt; // Offset of the cache size in the header, filled in by save
+    size_t sumAt; // Offset of the content hash of the artifacts in the header, filled in by save
+
+    // Constructor writes the header for a parser kind and the content hash of its grammar file
+    CacheWriter(const string &kind, unsigned long long hash) {
+        put(GRAMMAR_CACHE_VERSION);
+        put(kind);
+        put(hash);
+        sizeAt = bytes.length();
+        put(0LL);
+        sumAt = bytes.length();
+        put(0ULL);
+    }
+
+    // Append raw bytes
+    void raw(const void *data, size_t size) {
+        bytes.append((const char *)data, size);
+    }
+
+    // Append an integer
+    void put(int value) {
+        raw(&value, sizeof(value));
+    }
+
+    // Append a 64-bit integer
+    void put(long long value) {
+        raw(&value, sizeof(value));
+    }
+
+    // Append an unsigned 64-bit integer
+    void put(unsigned long long value) {
+        raw(&value, sizeof(value));
+    }
+
+    // Append a string as its length and bytes
+    void put(const string &value) {
+        put((int)value.length());
+        raw(value.data(), value.length());
+    }
+
+    // Append a count of integers followed by the integers
+    void put(const int *values, int count) {
+        put(count);
+        raw(values, count * sizeof(int));
+    }
+
+    // Append a vector of integers
+    void put(const vector<int> &values) {
+        put(values.data(), values.size());
+    }
+
+    // Append a vector of flags, one byte each
+    void put(const vector<bool> &values) {
+        put((int)values.size());
+        for (bool value : values)
+            bytes += (char)value;
+    }
+
+    // Append a vector of strings
+    void put(const vector<string> &values) {
+        put((int)values.size());
+        for (const string &value : values)
+            put(value);
+    }
+
+    // Append a set of integers in ascending order
+    void put(const set<int> &values) {
+        put((int)values.size());
+        for (int value : values)
+            put(value);
+    }
+
+    // Append a vector of sets of integers
+    void put(const vector<set<int>> &values) {
+        put((int)values.size());
+        for (const set<int> &value : values)
+            put(value);
+    }
+
+    // Write the cache file, returning false if it cannot be written
+    bool save(const string &path) {
+        long long size = bytes.length();
+        size_t bodyAt = sumAt + sizeof(unsigned long long); // Offset of the first artifact after the header
+        unsigned long long sum = contentHash(bytes.data() + bodyAt, size - bodyAt);
+        memcpy(&bytes[sizeAt], &size, sizeof(size));
+        memcpy(&bytes[sumAt], &sum, sizeof(sum));
+        ofstream out(path, ios::binary);
+        out.write(bytes.data(), bytes.length());
+        return out.good();
+    }
+};
+
+// artifacts decoded in place from a cache file mapped read-only
+struct CacheReader {
+    MappedFile file; // Mapped cache file
+    const char *at; // Next byte to decode
+    const char *stop; // End of the cache
+    bool ok; // Whether the header matched and every read so far stayed inside the cache
+
+    // Constructor maps a cache file and checks its header against a parser kind and the content hash of its grammar file
+    CacheReader(const string &path, const string &kind, unsigned long long hash) : file(path), at(file.data), stop(file.data), ok(file.isOpen()) {
+        if (!ok)
+            return;
+        stop = file.data + file.length;
+        int version = 0;
+        string cachedKind;
+        unsigned long long cachedHash = 0;
+        long long size = 0;
+        unsigned long long sum = 0;
+        get(version);
+        get(cachedKind);
+        get(cachedHash);
+        get(size);
+        get(sum);
+        ok = ok && version == GRAMMAR_CACHE_VERSION && cachedKind == kind && cachedHash == hash && size == file.length;
+        ok = ok && contentHash(at, stop - at) == sum; // A cache corrupted after it was written is rebuilt
+    }
+
+    // Copy raw bytes out of the cache, failing if fewer are left
+    bool raw(void *data, size_t size) {
+        if (!ok || (size_t)(stop - at) < size)
+            return ok = false;
+        if (size > 0)
+            memcpy(data, at, size);
+        at += size;
+        return true;
+    }
+
+    // Read a count of items of the given size, failing if the cache is too short to hold them
+    int count(size_t itemSize) {
+        int n = 0;
+        if (raw(&n, sizeof(n)) && (n < 0 || (size_t)(stop - at) < n * itemSize))
+            ok = false;
+        return ok ? n : 0;
+    }
+
+    // Read an integer
+    bool get(int &value) {
+        return raw(&value, sizeof(value));
+    }
+
+    // Read a 64-bit integer
+    bool get(long long &value) {
+        return raw(&value, sizeof(value));
+    }
+
+    // Read an unsigned 64-bit integer
+    bool get(unsigned long long &value) {
+        return raw(&value, sizeof(value));
+    }
+
+    // Read a string
+    bool get(string &value) {
+        int n = count(1);
+        value.assign(at, n);
+        at += n;
+        return ok;
+    }
+
+    // Read a vector of integers
+    bool get(vector<int> &values) {
+        int n = count(sizeof(int));
+        values.resize(n);
+        return raw(values.data(), n * sizeof(int));
+    }
+
+    // Read a vector of flags
+    bool get(vector<bool> &values) {
+        int n = count(1);
+        values.assign(at, at + n);
+        at += n;
+        return ok;
+    }
+
+    // Read a vector of strings
+    bool get(vector<string> &values) {
+        int n = count(sizeof(int));
+        values.resize(n);
+        for (int i = 0; i < n && ok; i++)
+            get(values[i]);
+        return ok;
+    }
+
+    // Read a set of integers stored in ascending order
+    bool get(set<int> &values) {
+        int n = count(sizeof(int));
+        values.clear();
+        for (int i = 0; i < n && ok; i++) {
+            int value;
+            get(value);
+            values.insert(values.end(), value);
+        }
+        return ok;
+    }
+
+    // Read a vector of sets of integers
+    bool get(vector<set<int>> &values) {
+        int n = count(sizeof(int));
+        values.resize(n);
+        for (int i = 0; i < n && ok; i++)
+            get(values[i]);
+        return ok;
+    }
+    // Fail unless a condition on what was read holds, such as an id indexing a table of the size read before it
+    bool check(bool condition) {
+        if (!condition)
+            ok = false;
+        return ok;
+    }
+
+    // Fail unless a value lies in [low, high)
+    bool inRange(int value, int low, int high) {
+        return check(value >= low && value < high);
+    }
+
+    // Fail unless every value lies in [low, high)
+    bool inRange(const vector<int> &values, int low, int high) {
+        for (int value : values)
+            if (!inRange(value, low, high))
+                return false;
+        return ok;
+    }
+
+    // Fail unless every value of a set lies in [low, high), checking its smallest and largest values
+    bool inRange(const set<int> &values, int low, int high) {
+        return values.empty() || (inRange(*values.begin(), low, high) && inRange(*values.rbegin(), low, high));
+    }
+
+    // Fail unless every value of every set lies in [low, high)
+    bool inRange(const vector<set<int>> &values, int low, int high) {
+        for (const set<int> &value : values)
+            if (!inRange(value, low, high))
+                return false;
+        return ok;
+    }
+};
@@ -0,0 +1,311 @@
+
+// FIRST, FOLLOW and nullable sets of a grammar, computed over dense bitsets of terminals.
+// FIRST and FOLLOW are each a set relation solved by the digraph algorithm, so cyclic, left-recursive and nullable
+// dependencies all settle on the least solution in time linear in the relation, and every union is an OR of whole 64-bit words.
+
+// Set of terminals stored one bit per terminal, indexed by the position of the terminal in the grammar
+struct SymbolSet {
+    vector<unsigned long long> words; // Bits of the set, 64 terminals per word
+
+    // Constructor to create an empty set able to hold the given number of terminals
+    SymbolSet(int size = 0) : words((size + 63) / 64, 0) {}
+
+    // Add a terminal by its position
+    void set(int position) {
+        words[position >> 6] |= 1ull << (position & 63);
+    }
+
+    // Whether a terminal is in the set
+    bool test(int position) const {
+        return words[position >> 6] >> (position & 63) & 1;
+    }
+
+    // Add every terminal of another set, returning whether the set grew
+    bool unite(const SymbolSet &other) {
+        unsigned long long grown = 0;
+        for (size_t i = 0; i < words.size(); i++) {
+            unsigned long long merged = words[i] | other.words[i];
+            grown |= merged ^ words[i];
+            words[i] = merged;
+        }
+        return grown != 0;
+    }
+
+    // Positions of the terminals in the set, in ascending order
+    vector<int> positions() const {
+        vector<int> result;
+        for (size_t i = 0; i < words.size(); i++)
+            for (unsigned long long word = words[i]; word != 0; word &= word - 1)
+                result.push_back(i * 64 + __builtin_ctzll(word));
+        return result;
+    }
+};
+
+// LL(1) table cell claimed by two productions of its non-terminal
+struct LL1Conflict {
+    int nonTerminal; // Row of the cell
+    int terminal; // Column of the cell
+    int first; // Earlier production claiming the cell
+    int second; // Later production claiming the cell
+
+    // Cell and productions as text, such as "M[E, id]: E -> id | E -> id + E"
+    string text(const Grammar &g) const {
+        return "M[" + g.names[nonTerminal] + ", " + g.names[terminal] + "]: " + g.names[nonTerminal] + " -> " + g.text(first) + " | " + g.names[nonTerminal] + " -> " + g.text(second);
+    }
+
+    // Write the conflict to a cache
+    void save(CacheWriter &out) const {
+        out.put(nonTerminal);
+        out.put(terminal);
+        out.put(first);
+        out.put(second);
+    }
+
+    // Read a conflict of a grammar written by save; false if the cache is too short or names a symbol or production the grammar lacks
+    bool load(CacheReader &in, const Grammar &g) {
+        in.get(nonTerminal);
+        in.get(terminal);
+        in.get(first);
+        in.get(second);
+        return in.inRange(nonTerminal, 0, g.names.size()) && in.inRange(terminal, 0, g.names.size()) && in.inRange(first, 0, g.size()) && in.inRange(second, 0, g.size());
+    }
+};
+
+// FIRST, FOLLOW and nullable sets of every non-terminal of a grammar
+struct GrammarSets {
+    const Grammar &gram; // Grammar the sets are computed for
+    vector<bool> nullable; // Whether each symbol derives the empty string, indexed by symbol id
+    vector<SymbolSet> first; // FIRST set of each symbol without "e", indexed by symbol id
+    vector<SymbolSet> follow; // FOLLOW set of each non-terminal, indexed by symbol id
+    vector<int> suffixBegin; // Index of the suffix at dot 0 of every production, followed by one suffix for every later dot
+    vector<SymbolSet> suffixFirst; // FIRST set without "e" of the RHS symbols from a dot to the end of their production
+    vector<bool> suffixNullable; // Whether the RHS symbols from a dot to the end of their production derive the empty string
+
+    // Constructor to prepare empty sets for the symbols of a grammar
+    GrammarSets(const Grammar &gram) : gram(gram) {}
+
+    // Find the nullable non-terminals by counting, for every production, the symbols of its RHS not yet known to be nullable
+    void findNullable() {
+        nullable.assign(gram.names.size(), false);
+        vector<int> pending(gram.size()); // Symbols of each production not yet known to be nullable
+        vector<vector<int>> uses(gram.names.size()); // Productions each non-terminal occurs in, once per occurrence
+        vector<int> worklist; // Non-terminals found nullable whose uses are not yet counted down
+        for (int p = 0; p < gram.size(); p++) {
+            pending[p] = gram.length(p);
+            for (const int *s = gram.begin(p); s != gram.end(p); s++)
+                if (gram.nonTerminal[*s])
+                    uses[*s].push_back(p);
+            if (pending[p] == 0 && !nullable[gram.lhs[p]]) {
+                nullable[gram.lhs[p]] = true;
+                worklist.push_back(gram.lhs[p]);
+            }
+        }
+        while (!worklist.empty()) {
+            int symbol = worklist.back();
+            worklist.pop_back();
+            for (int p : uses[symbol])
+                if (--pending[p] == 0 && !nullable[gram.lhs[p]]) {
+                    nullable[gram.lhs[p]] = true;
+                    worklist.push_back(gram.lhs[p]);
+                }
+        }
+    }
+
+    // Complete every set with the sets of the symbols it includes, following the digraph algorithm of DeRemer and
+    // Pennello: a Tarjan walk of the relation unites each set with those it includes as edges are crossed, and gives
+    // every strongly connected component the set of its root, so each edge is crossed once
+    static void digraph(vector<SymbolSet> &sets, const vector<vector<int>> &includes) {
+        int count = sets.size();
+        vector<int> depth(count, 0); // Depth in stack at which each symbol was reached, 0 before and INT_MAX once its component is done
+        vector<int> stack; // Symbols of the components not yet done
+        vector<array<int, 3>> path; // Symbols being walked, each with the next edge to cross and its own depth
+        for (int root = 0; root < count; root++) {
+            if (depth[root] != 0)
+                continue;
+            stack.push_back(root);
+            depth[root] = stack.size();
+            path.push_back({root, 0, depth[root]});
+            while (!path.empty()) {
+                int symbol = path.back()[0];
+                if (path.back()[1] < (int)includes[symbol].size()) {
+                    int included = includes[symbol][path.back()[1]++];
+                    if (depth[included] == 0) {
+                        // Walk the included symbol first, uniting its set into this one when it returns
+                        stack.push_back(included);
+                        depth[included] = stack.size();
+                        path.push_back({included, 0, depth[included]});
+                    } else {
+                        depth[symbol] = min(depth[symbol], depth[included]);
+                        sets[symbol].unite(sets[included]);
+                    }
+                    continue;
+                }
+
+                // Every edge is crossed: a symbol still at its own depth is the root of a component that is now done
+                if (depth[symbol] == path.back()[2]) {
+                    while (true) {
+                        int member = stack.back();
+                        stack.pop_back();
+                        depth[member] = INT_MAX;
+                        if (member == symbol)
+                            break;
+                        sets[member] = sets[symbol];
+                    }
+                }
+                path.pop_back();
+                if (!path.empty()) {
+                    int parent = path.back()[0];
+                    depth[parent] = min(depth[parent], depth[symbol]);
+                    sets[parent].unite(sets[symbol]);
+                }
+            }
+        }
+    }
+
+    // Compute the FIRST sets of all symbols, finding the nullable non-terminals first
+    void findFirsts() {
+        findNullable();
+        int count = gram.names.size();
+        first.assign(count, SymbolSet(gram.terminals.size()));
+        for (int terminal : gram.terminals)
+            first[terminal].set(gram.position[terminal]);
+
+        // FIRST(A) includes FIRST(X) for every X of a production of A that only nullable symbols precede
+        vector<vector<int>> includes(count);
+        for (int p = 0; p < gram.size(); p++)
+            for (const int *s = gram.begin(p); s != gram.end(p); s++) {
+                if (!gram.nonTerminal[*s]) {
+                    first[gram.lhs[p]].set(gram.position[*s]);
+                    break;
+                }
+                if (*s != gram.lhs[p])
+                    includes[gram.lhs[p]].push_back(*s);
+                if (!nullable[*s])
+                    break;
+            }
+        digraph(first, includes);
+        findSuffixFirsts();
+    }
+
+    // Compute FIRST and nullable of every production suffix, walking each RHS from the right
+    void findSuffixFirsts() {
+        suffixBegin.resize(gram.size());
+        int total = 0;
+        for (int p = 0; p < gram.size(); p++) {
+            suffixBegin[p] = total;
+            total += gram.length(p) + 1;
+        }
+        suffixFirst.assign(total, SymbolSet(gram.terminals.size()));
+        suffixNullable.assign(total, false);
+        for (int p = 0; p < gram.size(); p++) {
+            int at = suffixBegin[p] + gram.length(p); // The empty suffix after the last symbol
+            suffixNullable[at] = true;
+            for (const int *s = gram.end(p); s != gram.begin(p); at--) {
+                s--;
+                if (nullable[*s]) {
+                    suffixFirst[at - 1] = suffixFirst[at];
+                    suffixFirst[at - 1].unite(first[*s]);
+                    suffixNullable[at - 1] = suffixNullable[at];
+                } else
+                    suffixFirst[at - 1] = first[*s];
+            }
+        }
+    }
+
+    // FIRST set without "e" of the RHS symbols of a production from a dot to its end
+    const SymbolSet &suffixFirstAt(int p, int dot) const {
+        return suffixFirst[suffixBegin[p] + dot];
+    }
+
+    // Whether the RHS symbols of a production from a dot to its end derive the empty string
+    bool suffixNullableAt(int p, int dot) const {
+        return suffixNullable[suffixBegin[p] + dot];
+    }
+
+    // Compute the FOLLOW sets of all non-terminals from the suffix sets, after findFirsts
+    void findFollows() {
+        int count = gram.names.size();
+        follow.assign(count, SymbolSet(gram.terminals.size()));
+        if (gram.start >= 0)
+            follow[gram.start].set(gram.position[gram.endMarker]);
+
+        // FOLLOW(B) includes FIRST of what follows B in a production, and FOLLOW(A) too when that derives the empty string
+        vector<vector<int>> includes(count);
+        for (int p = 0; p < gram.size(); p++)
+            for (int dot = 0; dot < gram.length(p); dot++) {
+                int symbol = gram.begin(p)[dot];
+                if (!gram.nonTerminal[symbol])
+                    continue;
+                follow[symbol].unite(suffixFirstAt(p, dot + 1));
+                if (suffixNullableAt(p, dot + 1) && symbol != gram.lhs[p])
+                    includes[symbol].push_back(gram.lhs[p]);
+            }
+        digraph(follow, includes);
+    }
+
+    // Every LL(1) table cell claimed by two productions, after findFollows. A production is chosen on FIRST of its RHS,
+    // and on FOLLOW of its LHS too when the RHS is nullable; the cells of a non-terminal chosen twice are found with
+    // word-wide ANDs before its productions are paired up on them
+    vector<LL1Conflict> findConflicts() const {
+        vector<LL1Conflict> conflicts;
+        int cols = gram.terminals.size();
+        vector<SymbolSet> predicts; // Terminals each production of the current non-terminal is chosen on
+        for (int non_term : gram.nonterminals) {
+            int from = gram.lhsBegin[non_term], to = gram.lhsBegin[non_term + 1];
+            predicts.assign(to - from, SymbolSet(cols));
+            SymbolSet claimed(cols), twice(cols); // Terminals chosen by at least one and by at least two productions
+            for (int i = from; i < to; i++) {
+                SymbolSet &predict = predicts[i - from];
+                predict = suffixFirstAt(gram.byLhs[i], 0);
+                if (suffixNullableAt(gram.byLhs[i], 0))
+                    predict.unite(follow[non_term]);
+                for (size_t w = 0; w < predict.words.size(); w++) {
+                    twice.words[w] |= claimed.words[w] & predict.words[w];
+                    claimed.words[w] |= predict.words[w];
+                }
+            }
+            for (int col : twice.positions())
+                for (int i = from; i < to; i++)
+                    for (int j = i + 1; j < to && predicts[i - from].test(col); j++)
+                        if (predicts[j - from].test(col))
+                            conflicts.push_back({non_term, gram.terminals[col], gram.byLhs[i], gram.byLhs[j]});
+        }
+        return conflicts;
+    }
+
+    // Ids of the terminals of a set, with "e" added if requested
+    set<int> symbols(const SymbolSet &bits, bool withEpsilon) const {
+        set<int> result;
+        for (int position : bits.positions())
+            result.insert(result.end(), gram.terminals[position]);
+        if (withEpsilon)
+            result.insert(gram.epsilon);
+        return result;
+    }
+
+    // Set of the terminals with the given ids, any "e" left out
+    SymbolSet bits(const set<int> &ids) const {
+        SymbolSet result(gram.terminals.size());
+        for (int symbol : ids)
+            if (symbol != gram.epsilon)
+                result.set(gram.position[symbol]);
+        return result;
+    }
+
+    // FIRST sets of all symbols as sets of ids, "e" included for the nullable non-terminals
+    vector<set<int>> firstSets() const {
+        vector<set<int>> result(gram.names.size());
+        for (int symbol = 0; symbol < (int)gram.names.size(); symbol++)
+            if (symbol != gram.epsilon)
+                result[symbol] = symbols(first[symbol], nullable[symbol]);
+        return result;
+    }
+
+    // FOLLOW sets of all non-terminals as sets of ids
+    vector<set<int>> followSets() const {
+        vector<set<int>> result(gram.names.size());
+        for (int non_term : gram.nonterminals)
+            result[non_term] = symbols(follow[non_term], false);
+        return result;
+    }
+};
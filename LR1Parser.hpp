@@ -1,382 +1,142 @@
 
 // item in a Canonical LR(1) state
 struct item {
-    pair<string, string> production; // A production rule (lhs, rhs)
-    set<string> lookahead; // Lookahead symbols
+    int production; // Index of the production in the grammar
+    int dot; // Number of RHS symbols before the dot
+    set<int> lookahead; // Lookahead symbols
 
     // Compares two items for ordering
     bool operator < (const item &other) const {
-        return tie(production, lookahead) < tie(other.production, other.lookahead);
+        return tie(production, dot, lookahead) < tie(other.production, other.dot, other.lookahead);
     }
 
     // Checks equality of two items
     bool operator == (const item &other) const {
-        return production == other.production && lookahead == other.lookahead;
+        return production == other.production && dot == other.dot && lookahead == other.lookahead;
+    }
+
+    // Write the item to a cache
+    void save(CacheWriter &out) const {
+        out.put(production);
+        out.put(dot);
+        out.put(lookahead);
+    }
+
+    // Read an item of a grammar written by save; false if the cache is too short or names a production, dot or symbol the grammar lacks
+    bool load(CacheReader &in, const Grammar &g) {
+        in.get(production);
+        in.get(dot);
+        in.get(lookahead);
+        return in.inRange(production, 0, g.size()) && in.inRange(dot, 0, g.length(production) + 1) && in.inRange(lookahead, 0, g.names.size());
     }
 };
 
-// Canonical LR(1) parser
-struct LR1Parser {
-    Lexer &lexer; // Reference to the lexer for tokenization
+// Canonical LR(1) grammar: the augmented grammar with its FIRST sets, states and parsing table, compiled once
+// and shared by every LR1Parser that parses an input with it
+struct LR1Grammar {
     string grammar; // File path to the input grammar
-    string start_symbol; // Starting symbol of the grammar
-    Token currentToken; // Current token being processed
-    pair<string, string> *gram; // Array to store grammar rules as pairs of LHS and RHS
-    int prod_count; // Number of grammar productions
-    set<string> non_terms; // Set of non-terminal symbols
-    set<string> terms; // Set of terminal symbols
-    map<string, set<string>> firsts; // FIRST sets for grammar symbols
+    Grammar gram; // Augmented grammar rules with interned symbols
+    vector<set<int>> firsts; // FIRST sets of the grammar symbols, indexed by symbol id
+    GrammarSets sets; // FIRST, FOLLOW and production suffix sets as bitsets, filled while compiling
     map<int, vector<item>> canonical; // Canonical LR(1) states
     int state_count; // Number of states in the automaton
-    map<pair<int, string>, int> gotoMap; // GOTO transitions
+    map<pair<int, int>, int> gotoMap; // GOTO transitions on symbol ids
     map<int, item> reduceMap; // REDUCE mappings for states
-    int **parseTable; // Parsing table
-    string *errors; // Array to store error messages
-    int error_count; // Number of errors encountered
-    string **process; // Array to log processing steps
-    int process_count; // Count of processed steps
-    bool accepted; // flag to indicate whether input is accepted
-
-    // Constructor to initialize the parser with grammar and lexer
-    LR1Parser(Lexer &lexer, string grammar) : lexer(lexer), grammar(grammar), currentToken(lexer.getNextToken()), prod_count(0), state_count(0), error_count(0), process_count(0), accepted(true) {
-        // Allocate memory for grammar rules, errors, and process details
-        gram = new pair<string, string>[MAX_GRAMMAR_SIZE];
-        errors = new string[MAX_ERROR_SIZE];
-        process = new string*[MAX_PROCESS_SIZE];
-        for (int i = 0; i < MAX_PROCESS_SIZE; i++)
-            process[i] = new string[4];
-    }
-
-    // Eliminate left recursion from the grammar
-    void eliminateLeftRecursion(pair<string, string> *gram, int &prod_count) {
-        string arrangement[non_terms.size()]; // Array to keep track of non-terminals in order
-        int index = 0;
-
-        // Populate arrangement array with unique non-terminals
-        for (int i = 0; i < prod_count; i++) {
-            if (find(arrangement, arrangement + non_terms.size(), gram[i].first) == arrangement + non_terms.size())
-                arrangement[index++] = gram[i].first;
-        }
-
-        // Process each non-terminal in the arrangement
-        for (int i = 0; i < index; i++) {
-            for (int j = 0; j < i; j++) {
-                for (int k = 0; k < prod_count; k++) {
-                    string lhs = gram[k].first; // Left-hand side of the production
-                    if (lhs != arrangement[i])
-                        continue;
-                    string rhs = gram[k].second; // Right-hand side of the production
-                    string firstSymbol;
-
-                    // Extract the first symbol from RHS
-                    for (auto ch = rhs.begin(); ch != rhs.end(); ch++) {
-                        if (*ch != ' ')
-                            firstSymbol += *ch;
-                        if (*ch == ' ' || next(ch) == rhs.end()) {
-                            // Replace indirect left recursion
-                            if (firstSymbol == arrangement[j]) {
-                                bool flag1 = true;
-                                for (int l = 0; l < prod_count; l++) {
-                                    string lhs2 = gram[l].first;
-                                    if (lhs2 != arrangement[j])
-                                        continue;
-                                    string rhs2 = gram[l].second;
-                                    string new_rhs = rhs2;
-
-                                    // Handle epsilon or concatenate remaining RHS
-                                    if (new_rhs == "e")
-                                        new_rhs = rhs.substr(lhs2.length() + 1);
-                                    else if (next(ch) != rhs.end())
-                                        new_rhs += rhs.substr(lhs2.length());
-
-                                    if (flag1) {
-                                        gram[k] = make_pair(lhs, new_rhs);
-                                        flag1 = false;
-                                    } else {
-                                        for (int m = prod_count; m >= k + 1; m--)
-                                            gram[m] = gram[m - 1];
-                                        gram[k] = make_pair(lhs, new_rhs);
-                                        prod_count++;
-                                    }
-                                }
-                            }
-                            break;
-                        }
-                    }
-                }
-            }
-
-            // Detect and eliminate direct left recursion
-            bool flag = false;
-            for (int j = 0; j < prod_count; j++) {
-                if (flag)
-                    break;
-                string lhs = gram[j].first;
-                if (lhs != arrangement[i])
-                    continue;
-                string rhs = gram[j].second;
-                string firstSymbol;
-
-                // Extract first symbol and check for direct recursion
-                for (auto ch = rhs.begin(); ch != rhs.end(); ch++) {
-                    if (*ch != ' ')
-                        firstSymbol += *ch;
-                    if (*ch == ' ' || next(ch) == rhs.end()) {
-                        if (firstSymbol == lhs)
-                            flag = true;
-                        break;
-                    }
-                }
-            }
-
-            if (flag) {
-                int last;
-                string new_non_term = arrangement[i] + "'"; // Create a new non-terminal
-                non_terms.insert(new_non_term);
-
-                for (int j = 0; j < prod_count; j++) {
-                    string lhs = gram[j].first;
-                    if (lhs != arrangement[i])
-                        continue;
-                    string rhs = gram[j].second;
-                    string firstSymbol;
-
-                    for (auto ch = rhs.begin(); ch != rhs.end(); ch++) {
-                        if (*ch != ' ')
-                            firstSymbol += *ch;
-                        if (*ch == ' ' || next(ch) == rhs.end()) {
-                            last = j;
-                            string new_rhs;
-
-                            // Handle left-recursive and non-left-recursive productions
-                            if (firstSymbol == lhs) {
-                                if (next(ch) != rhs.end())
-                                    new_rhs += rhs.substr(firstSymbol.length() + 1);
-                                new_rhs += " " + new_non_term;
-                                gram[j] = make_pair(new_non_term, new_rhs);
-                            } else {
-                                if (rhs != "e")
-                                    new_rhs = rhs + " " + new_non_term;
-                                else
-                                    new_rhs = new_non_term;
-                                gram[j] = make_pair(lhs, new_rhs);
-                            }
-                            break;
-                        }
-                    }
-                }
-
-                // Add epsilon production for the new non-terminal
-                for (int j = prod_count; j >= last + 2; j--)
-                    gram[j] = gram[j - 1];
-                gram[last + 1] = make_pair(new_non_term, "e");
-                prod_count++;
-            }
-        }
-    }
-
-    // Compute the FIRST set for a given symbol or string
-    void first(string str, pair<string, string> *gram, int prod_count) {
-        // Check if the input is a terminal or epsilon
-        if (terms.find(str) != terms.end() || str == "e") {
-            firsts[str].insert(str);
-        } else if (non_terms.find(str) != non_terms.end()) {
-            // If input is a non-terminal, process its productions
-            for (int i = 0; i < prod_count; i++) {
-                if (gram[i].first != str)
-                    continue;
-                string rhs = gram[i].second;
-                string currentSymbol;
-
-                // Iterate over the symbols in the production's RHS
-                for (auto ch = rhs.begin(); ch != rhs.end(); ch++) {
-                    if (*ch != ' ')
-                        currentSymbol += *ch;
-                    if (*ch == ' ' || next(ch) == rhs.end()) {
-                        // Compute FIRST set for the current symbol if not already done
-                        if (firsts[currentSymbol].empty())
-                            first(currentSymbol, gram, prod_count);
-
-                        // Add the FIRST set of the current symbol to the FIRST set of the non-terminal
-                        if (firsts[currentSymbol].find("e") == firsts[currentSymbol].end()) {
-                            firsts[str].insert(firsts[currentSymbol].begin(), firsts[currentSymbol].end());
-                            break;
-                        }
-
-                        // Handle nullable symbols
-                        if (next(ch) != rhs.end()) {
-                            firsts[str].insert(firsts[currentSymbol].begin(), firsts[currentSymbol].end());
-                            firsts[str].erase("e");
-                            currentSymbol.clear();
-                            continue;
-                        }
-
-                        firsts[str].insert(firsts[currentSymbol].begin(), firsts[currentSymbol].end());
-                    }
-                }
-            }
-        } else {
-            // Handle complex strings with multiple symbols
-            string currentSymbol;
-            for (int i = 0; i < str.length(); i++) {
-                if (str[i] != ' ')
-                    currentSymbol += str[i];
-                if (str[i] == ' ' || i + 1 == str.length()) {
-                    // If current symbol is a terminal, add it to the FIRST set
-                    if (terms.find(currentSymbol) != terms.end()) {
-                        firsts[str].insert(currentSymbol);
-                        break;
-                    } else if (non_terms.find(currentSymbol) != non_terms.end()) {
-                        // If current symbol is a non-terminal, compute its FIRST set
-                        if (firsts[currentSymbol].empty())
-                            first(currentSymbol, gram, prod_count);
-
-                        // Add the FIRST set of the current symbol to the FIRST set of the string
-                        if (firsts[currentSymbol].find("e") == firsts[currentSymbol].end()) {
-                            firsts[str].insert(firsts[currentSymbol].begin(), firsts[currentSymbol].end());
-                            break;
-                        }
-
-                        // Handle nullable symbols within strings
-                        if (i + 1 != str.length()) {
-                            firsts[str].insert(firsts[currentSymbol].begin(), firsts[currentSymbol].end());
-                            firsts[str].erase("e");
-                            currentSymbol.clear();
-                            continue;
-                        }
-
-                        firsts[str].insert(firsts[currentSymbol].begin(), firsts[currentSymbol].end());
-                    }
-                }
-            }
-        }
+    int **parseTable; // Parsing table: a state to shift to or go to, minus the production to reduce by, LR_ACCEPT, or LR_ERROR
+    bool valid; // Whether the grammar file was read without syntax errors
+    const LexerSpec *spec; // Terminals of the grammar compiled for the lexer, NULL if the grammar is not valid
+
+    // Constructor to load the compiled grammar from its cache or compile it from the grammar file
+    LR1Grammar(string grammar) : grammar(grammar), sets(gram), state_count(0), parseTable(NULL) {
+        valid = compileGrammar();
+        spec = valid ? lexerSpecFor(gram.terminalNames()) : NULL; // Resolved once here instead of on every parse
     }
 
-    // Compute FIRST sets for all non-terminals
+    // Compute FIRST sets for all symbols with the shared bitset fixpoint, which follows left recursion as it is
     void findFirsts() {
-        pair<string, string> *temp = new pair<string, string>[MAX_GRAMMAR_SIZE];
-        copy(gram, gram + prod_count, temp);
-
-        int count = prod_count;
-        eliminateLeftRecursion(temp, count);
-
-        for (auto non_term = non_terms.begin(); non_term != non_terms.end(); non_term++) {
-            // Compute the FIRST set for non-terminals if not already computed
-            if (firsts[*non_term].empty())
-                first(*non_term, temp, count);
-        }
-
-        delete[] temp;
+        sets.findFirsts();
+        firsts = sets.firstSets();
     }
 
     // Expand the closure of a set of LR(1) items
     void closure(vector<item> &items) {
+        // Lookaheads of the items as bitsets of terminal positions while the closure grows, turned back into ids once it is complete
+        vector<SymbolSet> lookaheads;
+        for (const item &kernel : items)
+            lookaheads.push_back(sets.bits(kernel.lookahead));
         bool updated = true;
 
         while (updated) {
             updated = false;
             vector<item> newItems = items; // Copy of the current set of items
+            vector<SymbolSet> newLookaheads = lookaheads; // Lookaheads of the copied items
 
             // Iterate through all items in the current closure
-            for (auto it = items.begin(); it != items.end(); it++) {
-                string rhs = it->production.second; // Right-hand side of the production
-
-                // Find the position of the dot (.) in the production
-                int dotPos = rhs.find(".");
-                int nextPos = dotPos + 2; // Position of the symbol after the dot
+            for (size_t k = 0; k < items.size(); k++) {
+                int p = items[k].production;
 
                 // If there is no symbol after the dot, skip this item
-                if (nextPos >= rhs.length())
+                if (items[k].dot >= gram.length(p))
                     continue;
 
-                // Extract the next symbol after the dot
-                int spacePos = rhs.find(" ", nextPos);
-                if (spacePos == string::npos)
-                    spacePos = rhs.length();
-
-                string nextSymbol = rhs.substr(nextPos, spacePos - nextPos);
+                const int *nextSymbol = gram.begin(p) + items[k].dot; // Symbol after the dot
 
                 // If the next symbol is a non-terminal, add its productions to the closure
-                if (non_terms.find(nextSymbol) != non_terms.end()) {
-                    for (int i = 0; i < prod_count; i++) {
-                        if (gram[i].first == nextSymbol) {
-                            string new_rhs = "."; // Start the new production with a dot
-                            if (gram[i].second != "e")
-                                new_rhs += " " + gram[i].second;
-
-                            set<string> lookaheadSet;
-                            if (spacePos + 1 < rhs.length()) {
-                                // Compute the lookahead set for the new item
-                                string rest = rhs.substr(spacePos + 1);
-                                if (firsts[rest].empty())
-                                    first(rest, gram, prod_count);
-                                lookaheadSet = firsts[rest];
-                                if (firsts[rest].find("e") != firsts[rest].end()) {
-                                    lookaheadSet.erase("e");
-                                    lookaheadSet.insert(it->lookahead.begin(), it->lookahead.end());
-                                }
-                            } else
-                                lookaheadSet = it->lookahead;
-
-                            // Check if the new item already exists in the closure
-                            auto existing = newItems.end();
-                            for (auto itItem = newItems.begin(); itItem != newItems.end(); itItem++) {
-                                if (itItem->production == make_pair(nextSymbol, new_rhs)) {
-                                    existing = itItem;
-                                    break;
-                                }
-                            }
-                            // Merge lookahead sets or add a new item
-                            if (existing != newItems.end()) {
-                                set<string> mergedLookahead = existing->lookahead;
-                                int prevSize = mergedLookahead.size();
-                                mergedLookahead.insert(lookaheadSet.begin(), lookaheadSet.end());
-
-                                if (mergedLookahead.size() > prevSize) {
-                                    newItems.erase(existing);
-                                    newItems.push_back({ {nextSymbol, new_rhs}, mergedLookahead });
-                                    updated = true;
-                                }
-                            } else {
-                                newItems.push_back({ {nextSymbol, new_rhs}, lookaheadSet });
-                                updated = true;
-                            }
+                if (!gram.nonTerminal[*nextSymbol])
+                    continue;
+
+                // Lookaheads of the new items: FIRST of the rest of the production, and the item's own lookaheads if the rest is nullable
+                SymbolSet lookaheadSet = sets.suffixFirstAt(p, items[k].dot + 1);
+                if (sets.suffixNullableAt(p, items[k].dot + 1))
+                    lookaheadSet.unite(lookaheads[k]);
+                for (int i = gram.lhsBegin[*nextSymbol]; i < gram.lhsBegin[*nextSymbol + 1]; i++) {
+                    int q = gram.byLhs[i];
+                    if (gram.firstCopy(q) != q)
+                        continue; // A repeated production adds the same items as its first copy
+
+                    // Check if the new item already exists in the closure
+                    size_t existing = 0;
+                    while (existing < newItems.size() && (newItems[existing].production != q || newItems[existing].dot != 0))
+                        existing++;
+                    // Merge lookahead sets or add a new item
+                    if (existing < newItems.size()) {
+                        SymbolSet mergedLookahead = newLookaheads[existing];
+                        if (mergedLookahead.unite(lookaheadSet)) {
+                            newItems.erase(newItems.begin() + existing);
+                            newLookaheads.erase(newLookaheads.begin() + existing);
+                            newItems.push_back({q, 0, {}});
+                            newLookaheads.push_back(mergedLookahead);
+                            updated = true;
                         }
+                    } else {
+                        newItems.push_back({q, 0, {}});
+                        newLookaheads.push_back(lookaheadSet);
+                        updated = true;
                     }
                 }
             }
 
             items = newItems; // Update the closure with the new items
+            lookaheads = newLookaheads;
         }
+
+        for (size_t k = 0; k < items.size(); k++)
+            items[k].lookahead = sets.symbols(lookaheads[k], false);
     }
 
     // Compute the set of items transitioned to by a given symbol from the current items
-    vector<item> GoTo(vector<item> items, string symbol) {
+    vector<item> GoTo(vector<item> items, int symbol) {
         vector<item> newItems; // Store the resulting items after transition
 
         // Iterate through all items to find transitions on the given symbol
         for (auto it = items.begin(); it != items.end(); it++) {
-            string lhs = it->production.first; // Left-hand side of the production
-            string rhs = it->production.second; // Right-hand side of the production
-
-            int dotPos = rhs.find("."); // Position of the dot in the production
-            int nextPos = dotPos + 2; // Position of the symbol after the dot
-
             // Skip items where the dot is at the end of the production
-            if (nextPos >= rhs.length())
+            if (it->dot >= gram.length(it->production))
                 continue;
 
-            // Extract the symbol immediately after the dot
-            int spacePos = rhs.find(" ", nextPos);
-            if (spacePos == string::npos)
-                spacePos = rhs.length();
-
-            string nextSymbol = rhs.substr(nextPos, spacePos - nextPos);
-
-            // If the next symbol matches the given symbol, create a new item
-            if (nextSymbol == symbol) {
-                string new_rhs = rhs.substr(0, dotPos) + nextSymbol + " ." + rhs.substr(spacePos); // Move the dot
-                newItems.push_back({{lhs, new_rhs}, {it->lookahead}}); // Add the new item
+            // If the symbol after the dot matches the given symbol, move the dot over it
+            if (gram.begin(it->production)[it->dot] == symbol) {
+                newItems.push_back({it->production, it->dot + 1, it->lookahead}); // Add the new item
 
                 // Expand the closure for the new set of items
                 closure(newItems);
@@ -389,14 +149,15 @@ struct LR1Parser {
     // Generate the canonical collection of LR(1) items for the grammar
     void canonicalItems() {
         // Initialize the start item with the augmented grammar's start production
-        vector<item> startItem = {{{start_symbol, ". " + gram[0].second}, {"$"}}};
+        vector<item> startItem = {{0, 0, {gram.endMarker}}};
         closure(startItem); // Compute the closure of the start item
         canonical[state_count++] = startItem; // Add the start item to the canonical collection
 
-        // Combine non-terminals and terminals into a single symbol set
-        set<string> symbols;
-        symbols.insert(non_terms.begin(), non_terms.end());
-        symbols.insert(terms.begin(), terms.end());
+        // Every terminal and non-terminal, in the order of their ids
+        vector<int> symbols;
+        for (int symbol = 0; symbol < gram.names.size(); symbol++)
+            if (symbol != gram.epsilon)
+                symbols.push_back(symbol);
 
         bool updated = true; // Flag to track if new states are added
         while (updated) {
@@ -405,47 +166,36 @@ struct LR1Parser {
 
             // Iterate over all existing states
             for (auto it = newCanonical.begin(); it != newCanonical.end(); it++) {
-                for (auto symbol = symbols.begin(); symbol != symbols.end(); symbol++) {
+                for (int symbol : symbols) {
                     vector<item> items; // Items transitioning on the current symbol
 
                     // Find items in the current state with a transition on the symbol
                     for (auto itItem = it->second.begin(); itItem != it->second.end(); itItem++) {
-                        string lhs = itItem->production.first;
-                        string rhs = itItem->production.second;
-                        int dotPos = rhs.find(".");
-                        int nextPos = dotPos + 2;
-
-                        if (nextPos >= rhs.length()) {
+                        if (itItem->dot >= gram.length(itItem->production)) {
                             reduceMap[it->first] = *itItem; // Mark the item for reduction
                             continue;
                         }
 
-                        int spacePos = rhs.find(" ", nextPos);
-                        if (spacePos == string::npos)
-                            spacePos = rhs.length();
-
-                        string nextSymbol = rhs.substr(nextPos, spacePos - nextPos);
-
-                        if (nextSymbol == *symbol)
+                        if (gram.begin(itItem->production)[itItem->dot] == symbol)
                             items.push_back(*itItem); // Add items transitioning on the symbol
                     }
 
                     if (!items.empty()) {
-                        vector<item> state = GoTo(items, *symbol); // Compute the new state
+                        vector<item> state = GoTo(items, symbol); // Compute the new state
                         bool exists = false;
 
                         // Check if the state already exists in the canonical collection
                         for (auto itState = newCanonical.begin(); itState != newCanonical.end(); itState++) {
                             if (itState->second == state) {
                                 exists = true;
-                                gotoMap[{it->first, *symbol}] = itState->first; // Link the transition
+                                gotoMap[{it->first, symbol}] = itState->first; // Link the transition
                                 break;
                             }
                         }
 
                         // If the state is new, add it to the collection
                         if (!exists) {
-                            gotoMap[{it->first, *symbol}] = state_count;
+                            gotoMap[{it->first, symbol}] = state_count;
                             newCanonical[state_count++] = state;
                             updated = true; // Mark that the collection has been updated
                         }
@@ -456,249 +206,334 @@ struct LR1Parser {
         }
     }
 
-    // Generate grammar rules from an input file
-    void generateGrammar() {
-        fstream grammar_file;
-        grammar_file.open(grammar); // Open the grammar file
-
-        // Read grammar rules from the file
-        while (!grammar_file.eof() && prod_count < MAX_GRAMMAR_SIZE) {
-            char buffer[100]; // Buffer to store each line of the grammar
-            grammar_file.getline(buffer, 99); // Read a line from the file
-            string lhs; // Left-hand side of the production
-            int i = 0;
-
-            // Extract the left-hand side (LHS) of the production
-            while (buffer[i] != ' ')
-                lhs += buffer[i++];
-            i += 4; // Skip over the " -> "
-
-            string rhs; // Right-hand side of the production
-            // Extract the right-hand side (RHS) and handle multiple productions
-            while (buffer[i] != '\0') {
-                rhs += buffer[i++];
-                if (buffer[i] == '|') { // Handle multiple productions separated by '|'
-                    rhs.pop_back(); // Remove trailing space before '|'
-                    if (prod_count == 0)
-                        gram[prod_count++] = make_pair(lhs + "'", lhs); // Augmented grammar start rule
-                    gram[prod_count++] = make_pair(lhs, rhs); // Add the production
-                    rhs.clear();
-                    i += 2; // Skip over " | "
-                }
-            }
-            if (prod_count == 0)
-                gram[prod_count++] = make_pair(lhs + "'", lhs); // Augmented grammar start rule
-            gram[prod_count++] = make_pair(lhs, rhs);  // Add the last production
+
+    // Generate grammar rules from the input file, augmented with a new start symbol; false if the file has syntax errors
+    bool generateGrammar() {
+        bool valid = gram.read(grammar);
+        if (valid)
+            gram.augment();
+        gram.finish();
+        return valid;
+    }
+
+    // Write the grammar, its FIRST sets, the states with their transitions and the parsing table to their cache
+    void saveArtifacts(unsigned long long hash) {
+        CacheWriter cache("lr1", hash);
+        gram.save(cache);
+        cache.put(firsts);
+        cache.put(state_count);
+        cache.put((int)canonical.size());
+        for (auto it = canonical.begin(); it != canonical.end(); it++) {
+            cache.put(it->first);
+            cache.put((int)it->second.size());
+            for (const item &stateItem : it->second)
+                stateItem.save(cache);
+        }
+        cache.put((int)gotoMap.size());
+        for (auto it = gotoMap.begin(); it != gotoMap.end(); it++) {
+            cache.put(it->first.first);
+            cache.put(it->first.second);
+            cache.put(it->second);
         }
+        cache.put((int)reduceMap.size());
+        for (auto it = reduceMap.begin(); it != reduceMap.end(); it++) {
+            cache.put(it->first);
+            it->second.save(cache);
+        }
+        int numSymbols = gram.nonterminals.size() + gram.terminals.size() - 1;
+        vector<int> cells; // Parsing table row by row
+        for (int i = 0; i < state_count; i++)
+            cells.insert(cells.end(), parseTable[i], parseTable[i] + numSymbols);
+        cache.put(cells);
+        cache.save(cachePath(grammar, "lr1"));
+    }
 
-        // Identify all non-terminals from the grammar
-        for (int i = 0; i < prod_count; i++)
-            non_terms.insert(gram[i].first);
-
-        // Identify all terminals from the grammar
-        for (int i = 0; i < prod_count; i++) {
-            string currentSymbol;
-            for (auto ch = gram[i].second.begin(); ch != gram[i].second.end(); ch++) {
-                if (*ch != ' ')
-                    currentSymbol += *ch; // Build symbols character by character
-                if (*ch == ' ' || next(ch) == gram[i].second.end()) {
-                    if (non_terms.find(currentSymbol) == non_terms.end())
-                        terms.insert(currentSymbol); // Add to terminals if not a non-terminal
-                    currentSymbol.clear();
-                }
+    // Load everything saveArtifacts writes from the cache; false if it is missing or stale
+    bool loadArtifacts(unsigned long long hash) {
+        CacheReader cache(cachePath(grammar, "lr1"), "lr1", hash);
+        int states = 0;
+        vector<int> cells; // Parsing table row by row
+        if (cache.ok && gram.load(cache) && cache.get(firsts) && cache.get(states)) {
+            int symbols = gram.names.size(); // Bound of every symbol id read back
+            cache.check(firsts.size() == symbols && states >= 0);
+            cache.inRange(firsts, 0, symbols);
+            for (int n = cache.count(2 * sizeof(int)); n > 0 && cache.ok; n--) {
+                int state = 0;
+                cache.get(state);
+                cache.inRange(state, 0, states);
+                vector<item> &items = canonical[state];
+                items.resize(cache.count(3 * sizeof(int)));
+                for (int i = 0; i < items.size() && cache.ok; i++)
+                    items[i].load(cache, gram);
             }
+            for (int n = cache.count(3 * sizeof(int)); n > 0 && cache.ok; n--) {
+                int state = 0, symbol = 0, target = 0;
+                cache.get(state);
+                cache.get(symbol);
+                cache.get(target);
+                if (cache.inRange(state, 0, states) && cache.inRange(symbol, 0, symbols) && cache.inRange(target, 0, states))
+                    gotoMap[{state, symbol}] = target;
+            }
+            for (int n = cache.count(4 * sizeof(int)); n > 0 && cache.ok; n--) {
+                int state = 0;
+                cache.get(state);
+                if (cache.inRange(state, 0, states))
+                    reduceMap[state].load(cache, gram);
+            }
+            cache.get(cells);
+
+            // Every cell shifts or goes to a state, reduces by a production other than the augmented one, accepts or fails
+            for (int i = 0; i < cells.size() && cache.ok; i++)
+                cache.check(cells[i] == LR_ACCEPT || cells[i] == LR_ERROR || (cells[i] > -gram.size() && cells[i] < states));
+        }
+
+        int numSymbols = gram.nonterminals.size() + gram.terminals.size() - 1;
+        if (!cache.ok || cells.size() != (size_t)states * numSymbols) {
+            // Drop what a stale or short cache left behind
+            gram = Grammar();
+            canonical.clear();
+            gotoMap.clear();
+            reduceMap.clear();
+            return false;
         }
+        state_count = states;
+        parseTable = new int*[state_count];
+        for (int i = 0; i < state_count; i++) {
+            parseTable[i] = new int[numSymbols];
+            copy(cells.begin() + (size_t)i * numSymbols, cells.begin() + (size_t)(i + 1) * numSymbols, parseTable[i]);
+        }
+        return true;
+    }
 
-        terms.erase("e"); // Remove epsilon from terminals
-        terms.insert("$"); // Add the end of input marker as a terminal
+    // Load the compiled grammar from its cache, or compile it from the grammar file and cache it; false if the file has syntax errors
+    bool compileGrammar() {
+        MappedFile source(grammar);
+        unsigned long long hash = contentHash(source.data, source.length);
+        if (source.isOpen() && loadArtifacts(hash))
+            return true;
 
-        start_symbol = gram[0].first; // Set the starting symbol from the first production
+        if (!generateGrammar()) // Generate the grammar rules, terminals, and non-terminals
+            return false;
+        findFirsts(); // Compute FIRST sets for all symbols
+        canonicalItems(); // Generate the canonical collection of LR(1) items
+        generateParsingTable(); // Generate the parsing table for the grammar
+        saveArtifacts(hash);
+        return true;
+    }
+
+    // Column of a symbol in the parsing table: the terminals, then the non-terminals other than the start symbol.
+    // A token the grammar does not declare (-1) gets the column after the terminals
+    int column(int symbol) const {
+        if (symbol < 0 || !gram.nonTerminal[symbol])
+            return symbol < 0 ? gram.terminals.size() : gram.position[symbol];
+        int col = gram.terminals.size() + gram.position[symbol];
+        return gram.position[symbol] > gram.position[gram.start] ? col - 1 : col;
     }
 
     // generate the parsing table for LR(1) grammar
     void generateParsingTable() {
-        int numSymbols = non_terms.size() + terms.size() - 1; // Total number of symbols
+        int numSymbols = gram.nonterminals.size() + gram.terminals.size() - 1; // Total number of symbols
 
         // Allocate memory for the parsing table and initialize it
         parseTable = new int*[state_count];
         for (int i = 0; i < state_count; i++)
             parseTable[i] = new int[numSymbols];
         for (int i = 0; i < state_count; i++)
-            fill(parseTable[i], parseTable[i] + numSymbols, -100); // Initialize all cells with a default value
+            fill(parseTable[i], parseTable[i] + numSymbols, LR_ERROR); // Initialize all cells with a default value
 
         // Populate the table with REDUCE actions from reduceMap
         for (auto it = reduceMap.begin(); it != reduceMap.end(); it++) {
             int state = it->first;
-            item reduceItem = it->second;
-            string lhs = reduceItem.production.first;
-            string rhs = "e"; // Default RHS for empty production
-
-            if (reduceItem.production.second != ".")
-                rhs = reduceItem.production.second.substr(0, reduceItem.production.second.length() - 2);
-
-            int col = distance(terms.begin(), terms.find("$")); // Column index for end-of-input symbol
-            if (lhs == start_symbol) {
-                parseTable[state][col] = 100; // ACCEPT action for the start production
+            const item &reduceItem = it->second;
+            if (gram.lhs[reduceItem.production] == gram.start) {
+                parseTable[state][column(gram.endMarker)] = LR_ACCEPT; // ACCEPT action for the start production
             } else {
-                for (auto itLookahead = reduceItem.lookahead.begin(); itLookahead != reduceItem.lookahead.end(); itLookahead++) {
-                    col = distance(terms.begin(), terms.find(*itLookahead)); // Column index for the lookahead symbol
-                    parseTable[state][col] = -(distance(gram, find(gram, gram + prod_count, make_pair(lhs, rhs)))); // REDUCE action
-                }
+                for (int symbol : reduceItem.lookahead)
+                    parseTable[state][column(symbol)] = -reduceItem.production; // REDUCE action
             }
         }
 
-        // Populate the table with SHIFT and GOTO actions from gotoMap
-        set<string> new_non_terms = non_terms;
-        new_non_terms.erase(start_symbol); // Exclude the start symbol from GOTO actions
-
+        // Populate the table with SHIFT and GOTO actions from gotoMap, excluding the start symbol
         for (auto it = gotoMap.begin(); it != gotoMap.end(); it++) {
-            pair<int, string> key = it->first;
-            int state = key.first;
-            string symbol = key.second;
-            int nextState = it->second;
-            int col;
-
-            if (terms.find(symbol) != terms.end()) {
-                col = distance(terms.begin(), terms.find(symbol)); // Column index for terminals
-                parseTable[state][col] = nextState; // SHIFT action
-            } else if (new_non_terms.find(symbol) != new_non_terms.end()) {
-                col = distance(new_non_terms.begin(), new_non_terms.find(symbol)) + terms.size(); // Column index for non-terminals
-                parseTable[state][col] = nextState; // GOTO action
-            }
+            int state = it->first.first;
+            int symbol = it->first.second;
+            if (symbol != gram.start)
+                parseTable[state][column(symbol)] = it->second; // SHIFT action for terminals, GOTO action for non-terminals
         }
     }
 
-    // parse the input string using the generated parsing table
-    void parse() {
-        generateGrammar(); // Generate the grammar rules, terminals, and non-terminals
+    // Destructor to release the parsing table
+    ~LR1Grammar() {
+        for (int i = 0; i < state_count; i++)
+            delete[] parseTable[i];
+        delete[] parseTable;
+    }
+};
 
-        findFirsts(); // Compute FIRST sets for all symbols
+// Canonical LR(1) parser: the state of parsing one input with a compiled grammar, reset for every new input
+struct LR1Parser {
+    const LR1Grammar &compiled; // Grammar compiled for this parser
+    const Grammar &gram; // Augmented grammar rules of the compiled grammar
+    Lexer *lexer; // Lexer of the input being parsed
+    Token currentToken; // Current token being processed
+    string *errors; // Array to store error messages
+    int error_count; // Number of errors encountered
+    string **process; // Array to log processing steps
+    int process_count; // Count of processed steps
+    bool accepted; // flag to indicate whether input is accepted
+    bool trace; // Whether every step is logged into process for the processing table
 
-        tic(StartLR1); // Start timer for parsing
+    // Constructor to initialize the parser with a compiled grammar and the lexer of its first input, tracing only on request
+    LR1Parser(const LR1Grammar &compiled, Lexer &lexer, bool trace = false) : compiled(compiled), gram(compiled.gram), lexer(&lexer), error_count(0), process_count(0), accepted(true), trace(trace) {
+        // Allocate memory for errors and process details
+        errors = new string[MAX_ERROR_SIZE];
+        process = new string*[MAX_PROCESS_SIZE];
+        for (int i = 0; i < MAX_PROCESS_SIZE; i++)
+            process[i] = new string[4];
+    }
 
-        canonicalItems(); // Generate the canonical collection of LR(1) items
+    // Start over with the lexer of a new input, keeping the compiled grammar and the allocated arrays
+    void reset(Lexer &input) {
+        for (int i = 0; i < process_count + 2 && i < MAX_PROCESS_SIZE; i++)
+            for (int j = 0; j < 4; j++)
+                process[i][j].clear();
+        lexer = &input;
+        error_count = 0;
+        process_count = 0;
+        accepted = true;
+    }
 
-        generateParsingTable(); // Generate the parsing table for the grammar
+    // Record an error message, dropping it once the error array is full
+    void error(const string &message) {
+        if (error_count < MAX_ERROR_SIZE)
+            errors[error_count++] = message;
+    }
+
+    // parse the input string using the generated parsing table
+    void parse() {
+        tic(StartLR1); // Start timer for parsing
+
+        // Reject the input if the grammar has syntax errors
+        if (!compiled.valid) {
+            for (const string &message : gram.errors)
+                error(message);
+            accepted = false;
+            return;
+        }
+        lexer->useTerminals(compiled.spec); // Lex with the terminals of this grammar
+        currentToken = lexer->getNextToken();
 
         // Define lexical error messages
         map<string, string> lexicalErrors = {
                 {"invalid-char", "Illegal character."},
                 {"invalid-num", "Invalid number format."},
-                {"invalid-id", "Invalid identifier."}
+                {"invalid-id", "Invalid identifier."},
+                {"overflow-num", "Number out of range."},
+                {"inexact-num", "Number cannot be represented exactly."},
+                {"invalid-utf8", "Malformed UTF-8 sequence."}
         };
 
         stack<int> st, stTemp; // Stack for states
         st.push(0);
 
-        stack<string> symbols, symbolsTemp; // Stack for grammar symbols
+        stack<int> symbols, symbolsTemp; // Stack for grammar symbols
 
-        string lookahead = currentToken.type; // Initialize the lookahead symbol
+        int lookahead = gram.kindSymbols[currentToken.kind]; // Terminal of the current token, -1 if the grammar does not declare it
 
-        int col = distance(terms.begin(), terms.find(lookahead)); // Find column index for lookahead
-        int action = parseTable[st.top()][col]; // Get the parsing table action
-
-        set<string> new_non_terms = non_terms;
-        new_non_terms.erase(start_symbol); // Remove start symbol from non-terminals
+        int col = compiled.column(lookahead); // Find column index for lookahead
+        int action = compiled.parseTable[st.top()][col]; // Get the parsing table action
 
         string stackResult;
         while (1) {
-            // Log the current state stack
-            stTemp = st;
-            stackResult.clear();
-            while (!stTemp.empty()) {
-                stackResult = to_string(stTemp.top()) + " " + stackResult;
-                stTemp.pop();
-            }
-            process[process_count][0] = stackResult;
-
-            // Log the current symbol stack
-            symbolsTemp = symbols;
-            stackResult.clear();
-            while (!symbolsTemp.empty()) {
-                stackResult = symbolsTemp.top() + " " + stackResult;
-                symbolsTemp.pop();
+            bool logging = trace && process_count + 2 < MAX_PROCESS_SIZE; // Whether this step goes into the processing table
+            if (logging) {
+                // Log the current state stack
+                stTemp = st;
+                stackResult.clear();
+                while (!stTemp.empty()) {
+                    stackResult = to_string(stTemp.top()) + " " + stackResult;
+                    stTemp.pop();
+                }
+                process[process_count][0] = stackResult;
+
+                // Log the current symbol stack
+                symbolsTemp = symbols;
+                stackResult.clear();
+                while (!symbolsTemp.empty()) {
+                    stackResult = gram.names[symbolsTemp.top()] + " " + stackResult;
+                    symbolsTemp.pop();
+                }
+                process[process_count++][1] = stackResult;
             }
-            process[process_count++][1] = stackResult;
-
-            // Determine the token representation based on its value
-            string token = currentToken.value.empty() ? lookahead : currentToken.value;
 
             // Handle invalid tokens
-            if (terms.find(lookahead) == terms.end()) {
-                process[process_count + 1][2] += lookahead + " ";
-                process[process_count - 1][3] = "error, skip '" + lookahead + "'.";
-                if (lexicalErrors.find(lookahead) != lexicalErrors.end())
-                    errors[error_count++] = "Lexical Error: Invalid token '<" + token + ">': " + lexicalErrors[lookahead] + " Column number: [" + to_string(lexer.pos - token.length() + 1) + "]";
+            if (!lexer->isTerminal(currentToken.kind)) {
+                string token = lexer->tokenText(currentToken); // Text of the offending token, only built for errors
+                if (logging) {
+                    process[process_count + 1][2] += currentToken.type() + " ";
+                    process[process_count - 1][3] = "error, skip '" + currentToken.type() + "'.";
+                }
+                if (lexicalErrors.find(currentToken.type()) != lexicalErrors.end())
+                    error("Lexical Error: Invalid token '<" + token + ">': " + lexicalErrors[currentToken.type()] + " " + lexer->location(currentToken.start));
                 else
-                    errors[error_count++] = "Lexical Error: Invalid token '<" + token + ">'. Column number: [" + to_string(lexer.pos - token.length() + 1) + "]";
-                currentToken = lexer.getNextToken();
-                lookahead = currentToken.type;
+                    error("Lexical Error: Invalid token '<" + token + ">'. " + lexer->location(currentToken.start));
+                currentToken = lexer->getNextToken();
+                lookahead = gram.kindSymbols[currentToken.kind];
                 accepted = false;
                 continue;
             }
 
             // Handle errors and termination cases
-            if (action == -100) {
-                set<string> expect;
-                for (int i = 0; i < terms.size(); i++) {
-                    if (parseTable[st.top()][i] >= 0 && parseTable[st.top()][i] != 100) {
-                        auto it = terms.begin();
-                        advance(it, i);
-                        expect.insert(*it);
-                    }
-                }
-
-                string expected;
-                for (auto it = expect.begin(); it != expect.end(); it++) {
-                    expected += *it;
-                    if (next(it) != expect.end())
-                        expected += "' or '";
-                }
-
-                process[process_count - 1][3] = "error";
+            if (action == LR_ERROR) {
+                set<int> expect;
+                for (int i = 0; i < gram.terminals.size(); i++)
+                    if (compiled.parseTable[st.top()][i] >= 0 && compiled.parseTable[st.top()][i] != LR_ACCEPT)
+                        expect.insert(gram.terminals[i]);
+                string expected = gram.list(expect, "' or '");
+                string token = lexer->tokenText(currentToken); // Text of the offending token, only built for errors
+
+                if (logging)
+                    process[process_count - 1][3] = "error";
                 if (token != "$") {
                     if (!expect.empty())
-                        errors[error_count++] = "Syntax Error: Unexpected token '" + token + "'. Expected one of: '" + expected + "'. Column number: [" + to_string(lexer.pos - token.length() + 1) + "]";
+                        error("Syntax Error: Unexpected token '" + token + "'. Expected one of: '" + expected + "'. " + lexer->location(currentToken.start));
                     else
-                        errors[error_count++] = "Syntax Error: Unexpected token '" + token + "'. Expected end of input. Column number: [" + to_string(lexer.pos - token.length() + 1) + "]";
+                        error("Syntax Error: Unexpected token '" + token + "'. Expected end of input. " + lexer->location(currentToken.start));
                 } else {
                     if (!expect.empty())
-                        errors[error_count++] = "Syntax Error: Unexpected end of input. Expected one of: '" + expected + "'. Column number: [" + to_string(lexer.pos - token.length() + 1) + "]";
+                        error("Syntax Error: Unexpected end of input. Expected one of: '" + expected + "'. " + lexer->location(currentToken.start));
                     else
-                        errors[error_count++] = "Syntax Error: Unexpected end of input. Column number: [" + to_string(lexer.pos - token.length() + 1) + "]";
+                        error("Syntax Error: Unexpected end of input. " + lexer->location(currentToken.start));
                 }
                 accepted = false;
                 break;
-            } else if (action == 100) { // ACCEPT case
-                process[process_count - 1][3] = "accept";
+            } else if (action == LR_ACCEPT) { // ACCEPT case
+                if (logging)
+                    process[process_count - 1][3] = "accept";
                 break;
             } else if (action >= 0) { // SHIFT case
-                process[process_count + 1][2] += lookahead + " ";
-                process[process_count - 1][3] = "shift";
+                if (logging) {
+                    process[process_count + 1][2] += gram.names[lookahead] + " ";
+                    process[process_count - 1][3] = "shift";
+                }
                 st.push(action);
                 symbols.push(lookahead);
-                currentToken = lexer.getNextToken();
-                lookahead = currentToken.type;
-                col = distance(terms.begin(), terms.find(lookahead));
-                action = parseTable[st.top()][col];
+                currentToken = lexer->getNextToken();
+                lookahead = gram.kindSymbols[currentToken.kind];
+                col = compiled.column(lookahead);
+                action = compiled.parseTable[st.top()][col];
             } else { // REDUCE case
-                string lhs = gram[-action].first;
-                string rhs = gram[-action].second;
-                process[process_count - 1][3] = "reduce by " + lhs + " -> " + rhs;
-                if (rhs != "e") {
-                    int count = 0;
-                    for (auto ch = rhs.begin(); ch != rhs.end(); ch++)
-                        if (*ch == ' ' || next(ch) == rhs.end())
-                            count++;
-                    for (int i = 0; i < count; i++) {
-                        st.pop();
-                        symbols.pop();
-                    }
+                int lhs = gram.lhs[-action];
+                if (logging)
+                    process[process_count - 1][3] = "reduce by " + gram.names[lhs] + " -> " + gram.text(-action);
+                for (int i = 0; i < gram.length(-action); i++) {
+                    st.pop();
+                    symbols.pop();
                 }
-                int col2 = distance(new_non_terms.begin(), new_non_terms.find(lhs)) + terms.size();
-                st.push(parseTable[st.top()][col2]);
+                int col2 = compiled.column(lhs);
+                st.push(compiled.parseTable[st.top()][col2]);
                 symbols.push(lhs);
-                action = parseTable[st.top()][col];
+                action = compiled.parseTable[st.top()][col];
             }
         }
 
@@ -707,10 +542,6 @@ struct LR1Parser {
 
     // Destructor to clean up dynamically allocated resources
     ~LR1Parser() {
-        for (int i = 0; i < state_count; i++)
-            delete[] parseTable[i];
-        delete[] parseTable;
-        delete[] gram;
         delete[] errors;
         for (int i = 0; i < MAX_PROCESS_SIZE; i++)
             delete[] process[i];
@@ -729,17 +560,17 @@ int LR1Menu(LR1Parser &parser) {
     SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 6);
     cout << "\t\t\t\t[*] Input Grammar [*]" << endl << endl;
     int num = 0;
-    for (int i = 0; i < parser.prod_count; i++)
-        if (parser.gram[i].first == parser.start_symbol)
-            cout << "\t\t\t\t" << num++ << ". " << parser.gram[i].first << " -> " << parser.gram[i].second << endl;
-    for (int i = 0; i < parser.prod_count; i++)
-        if (parser.gram[i].first != parser.start_symbol)
-            cout << "\t\t\t\t" << num++ << ". " << parser.gram[i].first << " -> " << parser.gram[i].second << endl;
+    for (int i = 0; i < parser.gram.size(); i++)
+        if (parser.gram.lhs[i] == parser.gram.start)
+            cout << "\t\t\t\t" << num++ << ". " << parser.gram.names[parser.gram.lhs[i]] << " -> " << parser.gram.text(i) << endl;
+    for (int i = 0; i < parser.gram.size(); i++)
+        if (parser.gram.lhs[i] != parser.gram.start)
+            cout << "\t\t\t\t" << num++ << ". " << parser.gram.names[parser.gram.lhs[i]] << " -> " << parser.gram.text(i) << endl;
     SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 7);
     cout << "\n\t\t\t\t------------------------------------------------------------------------" << endl << endl;
     SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 3);
     cout << "\t\t\t\t[*] Input String [*]" << endl << endl;
-    cout << "\t\t\t\t" << parser.lexer.input << endl << endl;
+    cout << "\t\t\t\t" << parser.lexer->input << endl << endl;
     SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 7);
     cout << "\t\t\t\t------------------------------------------------------------------------" << endl << endl;
     if (parser.accepted) {
@@ -782,16 +613,11 @@ void printCanonicalItems(LR1Parser &parser) {
         cout << "\t\t\t\t[#] CLR Canonical Items [#]\n\n";
         cout << "\t\t\t\t-------------------------------------------" << endl << endl;
         int count = 0;
-        for (auto state = parser.canonical.begin(); state != parser.canonical.end(); state++) {
+        for (auto state = parser.compiled.canonical.begin(); state != parser.compiled.canonical.end(); state++) {
             cout << "\t\t\t\tI" << count++ << endl << endl;
             for (auto itItem = state->second.begin(); itItem != state->second.end(); itItem++) {
-                cout << "\t\t\t\t[" <<itItem->production.first << " -> " << itItem->production.second << ", ";
-                for (auto it = itItem->lookahead.begin(); it != itItem->lookahead.end(); it++) {
-                    if (next(it) != itItem->lookahead.end())
-                        cout << *it << " / ";
-                    else
-                        cout << *it;
-                }
+                cout << "\t\t\t\t[" << parser.gram.names[parser.gram.lhs[itItem->production]] << " -> " << parser.gram.text(itItem->production, itItem->dot) << ", ";
+                cout << parser.gram.list(itItem->lookahead, " / ");
                 cout << "]" << endl << endl;
             }
             cout << "\n\t\t\t\t-------------------------------------------" << endl << endl;
@@ -812,7 +638,7 @@ void printGoToTable(LR1Parser &parser) {
         cout << "\n\n\n\n\t\t\t\t-------------------------------------------------------------------------------------------------------------------------------" << endl << endl;
         cout << "\t\t\t\t[#] Goto Table [#]\n\n";
 
-        int rows = parser.gotoMap.size() + 1;
+        int rows = parser.compiled.gotoMap.size() + 1;
         int cols = 2;
         int width = 29;
         string data[rows][cols];
@@ -820,19 +646,19 @@ void printGoToTable(LR1Parser &parser) {
         data[0][1] = "State";
 
         int count = 1;
-        for (int i = 0; i < parser.state_count; i++) {
-            for (auto it = parser.gotoMap.begin(); it != parser.gotoMap.end(); it++) {
+        for (int i = 0; i < parser.compiled.state_count; i++) {
+            for (auto it = parser.compiled.gotoMap.begin(); it != parser.compiled.gotoMap.end(); it++) {
                 if (it->first.first == i) {
-                    if (parser.non_terms.find(it->first.second) != parser.non_terms.end()) {
-                        data[count][0] = "GoTo ( " + to_string(i) + ", " + it->first.second + " )";
+                    if (parser.gram.nonTerminal[it->first.second]) {
+                        data[count][0] = "GoTo ( " + to_string(i) + ", " + parser.gram.names[it->first.second] + " )";
                         data[count++][1] = to_string(it->second);
                     }
                 }
             }
-            for (auto it = parser.gotoMap.begin(); it != parser.gotoMap.end(); it++) {
+            for (auto it = parser.compiled.gotoMap.begin(); it != parser.compiled.gotoMap.end(); it++) {
                 if (it->first.first == i) {
-                    if (parser.terms.find(it->first.second) != parser.terms.end()) {
-                        data[count][0] = "GoTo ( " + to_string(i) + ", " + it->first.second + " )";
+                    if (!parser.gram.nonTerminal[it->first.second]) {
+                        data[count][0] = "GoTo ( " + to_string(i) + ", " + parser.gram.names[it->first.second] + " )";
                         data[count++][1] = to_string(it->second);
                     }
                 }
@@ -871,50 +697,52 @@ void printLR1ParsingTable(LR1Parser &parser) {
         cout << "\n\n\n\n\t\t\t\t-------------------------------------------------------------------------------------------------------------------------------" << endl << endl;
         cout << "\t\t\t\t[*] Input Grammar [*]" << endl << endl;
         int num = 0;
-        for (int i = 0; i < parser.prod_count; i++)
-            if (parser.gram[i].first == parser.start_symbol)
-                cout << "\t\t\t\t" << num++ << ". " << parser.gram[i].first << " -> " << parser.gram[i].second << endl;
-        for (int i = 0; i < parser.prod_count; i++)
-            if (parser.gram[i].first != parser.start_symbol)
-                cout << "\t\t\t\t" << num++ << ". " << parser.gram[i].first << " -> " << parser.gram[i].second << endl;
+        for (int i = 0; i < parser.gram.size(); i++)
+            if (parser.gram.lhs[i] == parser.gram.start)
+                cout << "\t\t\t\t" << num++ << ". " << parser.gram.names[parser.gram.lhs[i]] << " -> " << parser.gram.text(i) << endl;
+        for (int i = 0; i < parser.gram.size(); i++)
+            if (parser.gram.lhs[i] != parser.gram.start)
+                cout << "\t\t\t\t" << num++ << ". " << parser.gram.names[parser.gram.lhs[i]] << " -> " << parser.gram.text(i) << endl;
 
         cout << "\n\t\t\t\t-------------------------------------------------------------------------------------------------------------------------------" << endl << endl;
         cout << "\t\t\t\t[#] Canonical LR(1) Parsing Table [#]\n\n";
 
-        int rows = parser.state_count + 2;
-        int cols = parser.non_terms.size() + parser.terms.size();
+        int rows = parser.compiled.state_count + 2;
+        int terms = parser.gram.terminals.size(); // Number of ACTION columns
+        int non_terms = parser.gram.nonterminals.size() - 1; // Number of GOTO columns, without the start symbol
+        int cols = non_terms + terms + 1;
         int width = 11;
         string data[rows][cols];
         data[0][1] = "Action";
         data[0][2] = "GoTo";
         data[1][0] = "State";
 
-        set<string> new_non_terms = parser.non_terms;
-        new_non_terms.erase(parser.start_symbol);
-        auto non_term = new_non_terms.begin();
-        auto term = parser.terms.begin();
         for (int i = 1; i < rows; i++) {
             for (int j = 0; j < cols; j++) {
                 if (i == 1) {
                     if (j == 0)
                         continue;
-                    if (term != parser.terms.end())
-                        data[i][j] = *term++;
-                    else
-                        data[i][j] = *non_term++;
+                    if (j - 1 < terms)
+                        data[i][j] = parser.gram.names[parser.gram.terminals[j - 1]];
+                    else {
+                        int non_term = j - 1 - terms; // Position of the non-terminal, skipping the start symbol
+                        if (non_term >= parser.gram.position[parser.gram.start])
+                            non_term++;
+                        data[i][j] = parser.gram.names[parser.gram.nonterminals[non_term]];
+                    }
                 } else if (j == 0) {
                     data[i][j] = to_string(i - 2);
                 } else {
-                    int action = parser.parseTable[i - 2][j - 1];
-                    if (j - 1 < parser.terms.size()) {
-                        if (action == 100)
+                    int action = parser.compiled.parseTable[i - 2][j - 1];
+                    if (j - 1 < terms) {
+                        if (action == LR_ACCEPT)
                             data[i][j] = "acc";
                         else if (action >= 0)
                             data[i][j] = "s" + to_string(action);
-                        else if (action > -100)
+                        else if (action != LR_ERROR)
                             data[i][j] = "r" + to_string(-action);
                     } else {
-                        if (action > -100)
+                        if (action != LR_ERROR)
                             data[i][j] = to_string(action);
                     }
                 }
@@ -932,14 +760,14 @@ void printLR1ParsingTable(LR1Parser &parser) {
                 cout << left << setfill(' ') << setw(width - padding) << data[0][0];
                 cout << (char)186;
 
-                padding = (parser.terms.size() * (width + 1) - 1 - data[0][1].length()) / 2;
+                padding = (terms * (width + 1) - 1 - data[0][1].length()) / 2;
                 cout << right << setfill(' ') << setw(padding) << ' ';
-                cout << left << setfill(' ') << setw(parser.terms.size() * (width + 1) - 1 - padding) << data[0][1];
+                cout << left << setfill(' ') << setw(terms * (width + 1) - 1 - padding) << data[0][1];
                 cout << (char)186;
 
-                padding = (new_non_terms.size() * (width + 1) - 1 - data[0][2].length()) / 2;
+                padding = (non_terms * (width + 1) - 1 - data[0][2].length()) / 2;
                 cout << right << setfill(' ') << setw(padding) << ' ';
-                cout << left << setfill(' ') << setw(new_non_terms.size() * (width + 1) - 1 - padding) << data[0][2];
+                cout << left << setfill(' ') << setw(non_terms * (width + 1) - 1 - padding) << data[0][2];
                 cout << (char)186;
 
                 cout << endl;
@@ -984,7 +812,7 @@ void printLR1ProcessingTable(LR1Parser &parser) {
         data[0][2] = "Input";
         data[0][3] = "Action";
 
-        data[1][2] = parser.lexer.getAllTokens();
+        data[1][2] = parser.lexer->getAllTokens();
         for (int i = 1; i < rows; i++) {
             for (int j = 0; j < cols; j++) {
                 if (j != 2)
@@ -1,238 +1,1400 @@
 
-// lexical token with its type and value
+// kinds of tokens produced by the lexer, used as indexes into tokenKinds
+enum TokenKind {
+    T_END, T_ID, T_INT_NUM, T_FLOAT_NUM,
+    T_IF, T_ELSE, T_TRUE, T_FALSE, T_AND, T_OR, T_NOT, T_INT, T_FLOAT,
+    T_PLUS, T_MINUS, T_STAR, T_SLASH, T_LPAREN, T_RPAREN, T_ASSIGN,
+    T_INVALID_CHAR, T_INVALID_NUM, T_INVALID_ID, T_OVERFLOW_NUM, T_INEXACT_NUM, T_INVALID_UTF8,
+    TOKEN_KINDS
+};
+
+// Type names of the token kinds, as they appear in the grammars
+string tokenKinds[MAX_TOKEN_KINDS] = {
+    "$", "id", "intNum", "floatNum",
+    "if", "else", "true", "false", "and", "or", "not", "int", "float",
+    "+", "-", "*", "/", "(", ")", "=",
+    "invalid-char", "invalid-num", "invalid-id", "overflow-num", "inexact-num", "invalid-utf8"
+};
+int tokenKindCount = TOKEN_KINDS; // Number of token kinds, growing as grammars declare new terminals
+
+// Kind of a token type name, registering a new kind for a terminal not seen before; -1 if tokenKinds is full
+short tokenKindOf(const string &name) {
+    for (int kind = 0; kind < tokenKindCount; kind++)
+        if (tokenKinds[kind] == name)
+            return kind;
+    if (tokenKindCount == MAX_TOKEN_KINDS)
+        return -1;
+    tokenKinds[tokenKindCount] = name;
+    return tokenKindCount++;
+}
+
+// Keywords of the language in the order of their kinds from T_IF, defined once for every lexer
+constexpr string_view keywords[] = {"if", "else", "true", "false", "and", "or", "not", "int", "float"};
+constexpr int KEYWORDS = sizeof(keywords) / sizeof(keywords[0]);
+constexpr int KEYWORD_SLOTS = 16;
+
+// Perfect hash of a word from its length and its first and last characters, collision-free on the keywords
+constexpr int keywordHash(string_view word) {
+    return (word.length() + (unsigned char)word[0] + (unsigned char)word[word.length() - 1] * 5) & (KEYWORD_SLOTS - 1);
+}
+
+// keyword kind stored in every slot of the perfect hash, T_ID for empty slots
+struct KeywordSlots {
+    short kinds[KEYWORD_SLOTS];
+};
+
+// Build the slots of the perfect hash at compile time
+constexpr KeywordSlots buildKeywordSlots() {
+    KeywordSlots slots = {};
+    for (int i = 0; i < KEYWORD_SLOTS; i++)
+        slots.kinds[i] = T_ID;
+    for (int i = 0; i < KEYWORDS; i++)
+        slots.kinds[keywordHash(keywords[i])] = T_IF + i;
+    return slots;
+}
+constexpr KeywordSlots keywordSlots = buildKeywordSlots();
+
+// Check at compile time that no two keywords share a slot
+constexpr bool keywordHashIsPerfect() {
+    for (int i = 0; i < KEYWORDS; i++)
+        if (keywordSlots.kinds[keywordHash(keywords[i])] != T_IF + i)
+            return false;
+    return true;
+}
+static_assert(keywordHashIsPerfect(), "keyword hash has a collision");
+static_assert(T_IF + KEYWORDS - 1 == T_FLOAT, "keywords must match the keyword token kinds");
+
+// Kind of a keyword, or T_ID if the word is not one
+inline short keywordKind(string_view word) {
+    if (word.length() < 2 || word.length() > 5)
+        return T_ID; // Shorter or longer than every keyword
+    short kind = keywordSlots.kinds[keywordHash(word)];
+    return kind != T_ID && keywords[kind - T_IF] == word ? kind : T_ID;
+}
+
+// character classes used by the lexer DFA
+enum CharClass {
+    C_OTHER, C_SPACE, C_LETTER, C_E, C_DIGIT, C_UNDERSCORE, C_DOT, C_SIGN, C_OPERATOR,
+    CHAR_CLASSES
+};
+
+// states of the lexer DFA; values from A_ID on are final actions taken without consuming the character
+enum LexerState {
+    S_START, S_ID, S_INT, S_DOT, S_FRAC, S_EXP_INT, S_SIGN_INT, S_EXP_DIGITS_INT,
+    S_EXP_FLOAT, S_SIGN_FLOAT, S_EXP_DIGITS_FLOAT, S_BAD_ID, S_OPERATOR, S_INVALID_CHAR,
+    LEXER_STATES,
+    A_ID = LEXER_STATES, A_INT, A_FLOAT, A_OPERATOR, A_INVALID_CHAR, A_INVALID_NUM, A_INVALID_ID, A_END, A_TERMINAL, A_INVALID_UTF8
+};
+
+// Character class of every byte value
+unsigned char charClass[256];
+
+// Token kind of every single-character operator, T_END for other characters
+short operatorKinds[256];
+
+// Transition table of the lexer DFA, indexed by state and character class
+const unsigned char transitions[LEXER_STATES][CHAR_CLASSES] = {
+    //                  other           space           letter          e               digit               _               .               + -             * / ( ) =
+    /* S_START */       {S_INVALID_CHAR, S_INVALID_CHAR, S_ID,           S_ID,           S_INT,              S_ID,           S_INVALID_CHAR, S_OPERATOR,     S_OPERATOR},
+    /* S_ID */          {A_ID,           A_ID,           S_ID,           S_ID,           S_ID,               S_ID,           A_ID,           A_ID,           A_ID},
+    /* S_INT */         {A_INT,          A_INT,          S_BAD_ID,       S_EXP_INT,      S_INT,              S_BAD_ID,       S_DOT,          A_INT,          A_INT},
+    /* S_DOT */         {A_INVALID_NUM,  A_INVALID_NUM,  A_INVALID_NUM,  A_INVALID_NUM,  S_FRAC,             A_INVALID_NUM,  A_INVALID_NUM,  A_INVALID_NUM,  A_INVALID_NUM},
+    /* S_FRAC */        {A_FLOAT,        A_FLOAT,        S_BAD_ID,       S_EXP_FLOAT,    S_FRAC,             S_BAD_ID,       A_FLOAT,        A_FLOAT,        A_FLOAT},
+    /* S_EXP_INT */     {A_INVALID_NUM,  A_INVALID_NUM,  S_BAD_ID,       S_BAD_ID,       S_EXP_DIGITS_INT,   A_INVALID_NUM,  A_INVALID_NUM,  S_SIGN_INT,     A_INVALID_NUM},
+    /* S_SIGN_INT */    {A_INVALID_NUM,  A_INVALID_NUM,  S_BAD_ID,       S_BAD_ID,       S_EXP_DIGITS_INT,   A_INVALID_NUM,  A_INVALID_NUM,  A_INVALID_NUM,  A_INVALID_NUM},
+    /* S_EXP_DIGITS_INT */ {A_INT,       A_INT,          S_BAD_ID,       S_BAD_ID,       S_EXP_DIGITS_INT,   S_BAD_ID,       A_INT,          A_INT,          A_INT},
+    /* S_EXP_FLOAT */   {A_INVALID_NUM,  A_INVALID_NUM,  S_BAD_ID,       S_BAD_ID,       S_EXP_DIGITS_FLOAT, A_INVALID_NUM,  A_INVALID_NUM,  S_SIGN_FLOAT,   A_INVALID_NUM},
+    /* S_SIGN_FLOAT */  {A_INVALID_NUM,  A_INVALID_NUM,  S_BAD_ID,       S_BAD_ID,       S_EXP_DIGITS_FLOAT, A_INVALID_NUM,  A_INVALID_NUM,  A_INVALID_NUM,  A_INVALID_NUM},
+    /* S_EXP_DIGITS_FLOAT */ {A_FLOAT,   A_FLOAT,        S_BAD_ID,       S_BAD_ID,       S_EXP_DIGITS_FLOAT, S_BAD_ID,       A_FLOAT,        A_FLOAT,        A_FLOAT},
+    /* S_BAD_ID */      {A_INVALID_ID,   A_INVALID_ID,   S_BAD_ID,       S_BAD_ID,       S_BAD_ID,           A_INVALID_ID,   A_INVALID_ID,   A_INVALID_ID,   A_INVALID_ID},
+    /* S_OPERATOR */    {A_OPERATOR,     A_OPERATOR,     A_OPERATOR,     A_OPERATOR,     A_OPERATOR,         A_OPERATOR,     A_OPERATOR,     A_OPERATOR,     A_OPERATOR},
+    /* S_INVALID_CHAR */ {A_INVALID_CHAR, A_INVALID_CHAR, A_INVALID_CHAR, A_INVALID_CHAR, A_INVALID_CHAR,     A_INVALID_CHAR, A_INVALID_CHAR, A_INVALID_CHAR, A_INVALID_CHAR}
+};
+
+// Fill the character class and operator tables used by the lexer DFA
+bool buildLexerTables() {
+    for (int ch = 0; ch < 256; ch++) {
+        charClass[ch] = C_OTHER;
+        operatorKinds[ch] = T_END;
+    }
+    for (int ch = 'a'; ch <= 'z'; ch++)
+        charClass[ch] = charClass[ch - 'a' + 'A'] = C_LETTER;
+    for (int ch = '0'; ch <= '9'; ch++)
+        charClass[ch] = C_DIGIT;
+    charClass['e'] = charClass['E'] = C_E;
+    charClass['_'] = C_UNDERSCORE;
+    charClass['.'] = C_DOT;
+    charClass[' '] = charClass['\t'] = charClass['\n'] = charClass['\v'] = charClass['\f'] = charClass['\r'] = C_SPACE;
+    for (int kind = T_PLUS; kind <= T_ASSIGN; kind++) {
+        unsigned char op = tokenKinds[kind][0];
+        charClass[op] = op == '+' || op == '-' ? C_SIGN : C_OPERATOR;
+        operatorKinds[op] = kind;
+    }
+    return true;
+}
+bool lexerTablesBuilt = buildLexerTables();
+
+// lexical token referring to its lexeme in the input buffer
 struct Token {
-    string type; // Type of the token
-    string value; // Lexical value of the token
+    short kind; // Kind of the token, an index into tokenKinds
+    long long start; // Offset of the lexeme in the input buffer
+    int length; // Length of the lexeme in bytes
+    int handle; // Symbol table handle of the token, or -1 if it has no entry
+
+    // Constructor to initialize token with its kind and the position of its lexeme
+    Token(short kind = T_END, long long start = 0, long long length = 0, int handle = -1) : kind(kind), start(start), length(length), handle(handle) {}
+
+    // Type name of the token
+    const string &type() const {
+        return tokenKinds[kind];
+    }
+};
+
+// structure-of-arrays buffer of tokens, filled in one pass by Lexer::tokenizeAll
+struct TokenBuffer {
+    short *kinds; // Kind of every token
+    long long *starts; // Offset of every lexeme in the input
+    int *lengths; // Length of every lexeme in bytes
+    int *handles; // Symbol table handle of every token, or -1
+    long long size; // Number of tokens, including the final end token
+    long long capacity; // Allocated number of tokens
+
+    // Default constructor allocates an empty buffer
+    TokenBuffer() : kinds(NULL), starts(NULL), lengths(NULL), handles(NULL), size(0), capacity(0) {
+        reserve(1024);
+    }
+
+    // Grow the arrays to hold at least the given number of tokens
+    void reserve(long long tokens) {
+        if (tokens <= capacity)
+            return;
+        short *newKinds = new short[tokens];
+        long long *newStarts = new long long[tokens];
+        int *newLengths = new int[tokens];
+        int *newHandles = new int[tokens];
+        for (long long i = 0; i < size; i++) {
+            newKinds[i] = kinds[i];
+            newStarts[i] = starts[i];
+            newLengths[i] = lengths[i];
+            newHandles[i] = handles[i];
+        }
+        release();
+        kinds = newKinds;
+        starts = newStarts;
+        lengths = newLengths;
+        handles = newHandles;
+        capacity = tokens;
+    }
 
-    // Constructor to initialize token with type and value
-    Token(string t = "", string v = "") : type(t), value(v) {}
+    // Append a token to the end of the buffer
+    void push(const Token &token) {
+        if (size == capacity)
+            reserve(capacity * 2);
+        kinds[size] = token.kind;
+        starts[size] = token.start;
+        lengths[size] = token.length;
+        handles[size++] = token.handle;
+    }
+
+    // Replace the count tokens from index from with the tokens of another buffer, moving the offsets of the tokens after them by shift
+    void splice(long long from, long long count, const TokenBuffer &with, long long shift) {
+        long long tail = size - (from + count); // Tokens kept after the replaced ones
+        reserve(size - count + with.size);
+        long long to = from + with.size; // New index of the first kept token
+        memmove(kinds + to, kinds + from + count, tail * sizeof(short));
+        memmove(starts + to, starts + from + count, tail * sizeof(long long));
+        memmove(lengths + to, lengths + from + count, tail * sizeof(int));
+        memmove(handles + to, handles + from + count, tail * sizeof(int));
+        memcpy(kinds + from, with.kinds, with.size * sizeof(short));
+        memcpy(starts + from, with.starts, with.size * sizeof(long long));
+        memcpy(lengths + from, with.lengths, with.size * sizeof(int));
+        memcpy(handles + from, with.handles, with.size * sizeof(int));
+        size = to + tail;
+        for (long long i = to; i < size; i++)
+            starts[i] += shift;
+    }
+
+    // Rebuild the token stored at an index
+    Token at(long long index) const {
+        return {kinds[index], starts[index], lengths[index], handles[index]};
+    }
+
+    // Write the tokens to a binary file, returning false if it cannot be written
+    bool save(const string &path) const {
+        ofstream out(path, ios::binary);
+        out.write((const char *)&size, sizeof(size));
+        out.write((const char *)kinds, size * sizeof(short));
+        out.write((const char *)starts, size * sizeof(long long));
+        out.write((const char *)lengths, size * sizeof(int));
+        out.write((const char *)handles, size * sizeof(int));
+        return out.good();
+    }
+
+    // Read tokens written by save, returning false if the file cannot be read
+    bool load(const string &path) {
+        ifstream in(path, ios::binary);
+        long long tokens = 0;
+        if (!in.read((char *)&tokens, sizeof(tokens)))
+            return false;
+        size = 0;
+        reserve(tokens);
+        in.read((char *)kinds, tokens * sizeof(short));
+        in.read((char *)starts, tokens * sizeof(long long));
+        in.read((char *)lengths, tokens * sizeof(int));
+        in.read((char *)handles, tokens * sizeof(int));
+        if (!in)
+            return false;
+        size = tokens;
+        return true;
+    }
 
-    // Set the type of the token
-    void setType(string t) {
-        type = t;
+    // Release the arrays
+    void release() {
+        delete[] kinds;
+        delete[] starts;
+        delete[] lengths;
+        delete[] handles;
     }
 
-    // Set the value of the token
-    void setValue(string v) {
-        value = v;
+    // Destructor to release the arrays
+    ~TokenBuffer() {
+        release();
     }
 };
 
-// symbol table for storing tokens
+// tokens changed by Lexer::applyEdit: the old tokens [first, first + removed) became [first, first + inserted)
+struct TokenEdit {
+    long long first; // Index of the first changed token, or -1 if the input cannot be edited
+    long long removed; // Number of old tokens replaced
+    long long inserted; // Number of new tokens in their place
+};
+
+// bump allocator holding the values of a symbol table in large blocks, released all at once
+struct Arena {
+    vector<char *> blocks; // Allocated blocks, the current one last
+    char *next; // Next free byte of the current block
+    size_t left; // Free bytes left in the current block
+
+    // Default constructor starts without any block
+    Arena() : next(NULL), left(0) {}
+
+    // Copy bytes into the arena and return a view of the copy
+    string_view store(string_view bytes) {
+        if (bytes.empty())
+            return string_view(); // Nothing to copy, and no block may exist yet
+        if (bytes.length() > left) {
+            // Start a new block, giving oversized values a block of their own
+            size_t size = max((size_t)ARENA_BLOCK_SIZE, bytes.length());
+            blocks.push_back(new char[size]);
+            next = blocks.back();
+            left = size;
+        }
+        memcpy(next, bytes.data(), bytes.length());
+        string_view copy(next, bytes.length());
+        next += bytes.length();
+        left -= bytes.length();
+        return copy;
+    }
+
+    // Destructor to release every block
+    ~Arena() {
+        for (int i = 0; i < blocks.size(); i++)
+            delete[] blocks[i];
+    }
+};
+
+// deduplicated pool of the decoded values of number literals, keyed by value
+struct ConstantPool {
+    vector<long long> ints; // Integer constants
+    vector<double> floats; // Floating-point constants
+    unordered_map<long long, int> intIndex; // Index of every integer constant
+    unordered_map<unsigned long long, int> floatIndex; // Index of every floating-point constant, keyed by its bit pattern
+
+    // Add an integer constant unless present and return its index
+    int addInt(long long value) {
+        auto it = intIndex.try_emplace(value, ints.size()).first;
+        if (it->second == ints.size())
+            ints.push_back(value);
+        return it->second;
+    }
+
+    // Add a floating-point constant unless present and return its index
+    int addFloat(double value) {
+        unsigned long long bits;
+        memcpy(&bits, &value, sizeof(bits));
+        auto it = floatIndex.try_emplace(bits, floats.size()).first;
+        if (it->second == floats.size())
+            floats.push_back(value);
+        return it->second;
+    }
+};
+
+// entry of the symbol table with its type and attribute value
+struct Symbol {
+    short kind; // Kind of the symbol, an index into tokenKinds
+    string_view value; // Attribute value of the symbol, stored in the arena of its table
+    int constant; // Index of the decoded value in the constant pool for number symbols, -1 for others
+    int uses; // Number of tokens made so far that refer to the symbol
+
+    // Type name of the symbol
+    const string &type() const {
+        return tokenKinds[kind];
+    }
+};
+
+// symbol table for storing tokens, indexed by open-addressing hash tables on type and value
 struct SymbolTable {
-    Token token; // Token stored in the current entry
-    SymbolTable *next; // Pointer to the next entry
-    static int count; // Static counter to track the number of symbols
-
-    // Default constructor initializes the linked list node
-    SymbolTable() : next(NULL) {}
-
-    // Constructor to initialize a node with a token
-    SymbolTable(Token token) : token(token), next(NULL) {}
-
-    // Insert a new token into the symbol table
-    void insert(Token newToken) {
-        SymbolTable *current = this;
-        if (current->token.type.empty()) {
-            // If the first node is empty, initialize it with the new token
-            current->token.type = newToken.type;
-            current->token.value = newToken.value;
-        } else {
-            // Traverse to the end of the linked list to insert the new token
-            while (current->next != NULL) {
-                current = current->next;
+    Symbol *entries; // Symbols in insertion order, addressed by their handle, kept contiguous for iteration
+    Arena values; // Storage of the symbol values
+    ConstantPool constants; // Decoded values of the number symbols
+    bool *removed; // Flags marking entries that have been removed
+    int size; // Number of used entries, including removed ones
+    int capacity; // Allocated number of entries
+    int *typeIndex; // Hash slots mapping a type to the handle of its first entry (-1 empty, -2 deleted)
+    int *valueIndex; // Hash slots mapping a value to the handle of its first entry (-1 empty, -2 deleted)
+    int slots; // Number of slots in each hash index (always a power of two)
+    int count; // Number of symbols in this table, not counting removed ones
+
+    // Default constructor allocates an empty table
+    SymbolTable() : size(0), capacity(16), slots(32), count(0) {
+        entries = new Symbol[capacity];
+        removed = new bool[capacity];
+        typeIndex = new int[slots];
+        valueIndex = new int[slots];
+        fill(typeIndex, typeIndex + slots, -1);
+        fill(valueIndex, valueIndex + slots, -1);
+    }
+
+    // Hash a key with FNV-1a
+    static unsigned int hash(string_view key) {
+        unsigned int h = 2166136261u;
+        for (int i = 0; i < key.length(); i++) {
+            h ^= (unsigned char)key[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    // Find the slot holding the key, or the slot where the key should be inserted
+    int findSlot(int *index, string_view key, bool byType) {
+        int mask = slots - 1;
+        int slot = hash(key) & mask;
+        int reusable = -1; // First deleted slot met while probing
+        while (index[slot] != -1) {
+            if (index[slot] == -2) {
+                if (reusable == -1)
+                    reusable = slot;
+            } else {
+                Symbol &symbol = entries[index[slot]];
+                if ((byType ? symbol.type() : symbol.value) == key)
+                    return slot;
+            }
+            slot = (slot + 1) & mask;
+        }
+        return reusable == -1 ? slot : reusable;
+    }
+
+    // Add an entry to an index unless its key is already present
+    void indexEntry(int *index, int handle, bool byType) {
+        Symbol &symbol = entries[handle];
+        int slot = findSlot(index, byType ? symbol.type() : symbol.value, byType);
+        if (index[slot] < 0)
+            index[slot] = handle;
+    }
+
+    // Point an index slot to the next live entry with the same key, or delete the key
+    void reindexEntry(int *index, int handle, bool byType) {
+        string_view key = byType ? entries[handle].type() : entries[handle].value;
+        int slot = findSlot(index, key, byType);
+        if (index[slot] != handle)
+            return;
+        index[slot] = -2;
+        for (int i = handle + 1; i < size; i++) {
+            if (!removed[i] && (byType ? entries[i].type() : entries[i].value) == key) {
+                index[slot] = i;
+                break;
             }
-            current->next = new SymbolTable(newToken);
         }
+    }
+
+    // Grow the entry arrays and the hash indexes when they get too full
+    void reserve() {
+        if (size == capacity) {
+            Symbol *newEntries = new Symbol[capacity * 2];
+            bool *newRemoved = new bool[capacity * 2];
+            memcpy(newEntries, entries, size * sizeof(Symbol));
+            memcpy(newRemoved, removed, size * sizeof(bool));
+            delete[] entries;
+            delete[] removed;
+            entries = newEntries;
+            removed = newRemoved;
+            capacity *= 2;
+        }
+
+        // Keep the load factor of both indexes at most one half
+        if ((size + 1) * 2 > slots) {
+            slots *= 2;
+            delete[] typeIndex;
+            delete[] valueIndex;
+            typeIndex = new int[slots];
+            valueIndex = new int[slots];
+            fill(typeIndex, typeIndex + slots, -1);
+            fill(valueIndex, valueIndex + slots, -1);
+            for (int i = 0; i < size; i++) {
+                if (removed[i])
+                    continue;
+                indexEntry(typeIndex, i, true);
+                indexEntry(valueIndex, i, false);
+            }
+        }
+    }
+
+    // Insert a new symbol into the symbol table and return its handle
+    int insert(short kind, string_view value = "") {
+        reserve();
+        int handle = size++;
+        entries[handle].kind = kind;
+        entries[handle].value = values.store(value);
+        entries[handle].constant = -1;
+        entries[handle].uses = 0;
+        removed[handle] = false;
+        indexEntry(typeIndex, handle, true);
+        indexEntry(valueIndex, handle, false);
         count++;
+        return handle;
+    }
+
+    // Remove the first symbol with the specified value from the symbol table
+    bool remove(string_view value) {
+        int handle = searchValue(value);
+        if (handle == -1)
+            return false;
+        removeAt(handle);
+        return true;
+    }
+
+    // Remove the symbol with the specified handle from the symbol table
+    void removeAt(int handle) {
+        removed[handle] = true;
+        reindexEntry(typeIndex, handle, true);
+        reindexEntry(valueIndex, handle, false);
+        count--;
+    }
+
+    // Search for a symbol by its type and return its handle, or -1 if absent
+    int searchType(string_view type) {
+        int slot = findSlot(typeIndex, type, true);
+        return typeIndex[slot] < 0 ? -1 : typeIndex[slot];
+    }
+
+    // Search for a symbol by its value and return its handle, or -1 if absent
+    int searchValue(string_view value) {
+        int slot = findSlot(valueIndex, value, false);
+        return valueIndex[slot] < 0 ? -1 : valueIndex[slot];
+    }
+
+    // Access the symbol stored under a handle
+    Symbol &at(int handle) {
+        return entries[handle];
+    }
+
+    // Decoded value of an intNum symbol
+    long long intValue(int handle) {
+        return constants.ints[entries[handle].constant];
+    }
+
+    // Decoded value of a floatNum symbol
+    double floatValue(int handle) {
+        return constants.floats[entries[handle].constant];
+    }
+
+    // Destructor to release the entries and the hash indexes; the arena frees the values block by block
+    ~SymbolTable() {
+        delete[] entries;
+        delete[] removed;
+        delete[] typeIndex;
+        delete[] valueIndex;
     }
+};
+
+// line and column of a position in the input, both counted from 1
+struct SourcePosition {
+    long long line; // Line number
+    long long column; // Column number, in bytes from the start of the line
+};
+
+// read-only memory mapping of a source file, so it can be lexed in place without loading it
+struct MappedFile {
+    string path; // Path of the file
+    HANDLE file; // Handle of the open file
+    HANDLE mapping; // Handle of the file mapping object
+    const char *data; // First byte of the mapped view, or NULL if the file could not be mapped
+    long long length; // Size of the file in bytes
+    long long padding; // Number of zero bytes readable after the file, up to the end of its last page
+
+    // Constructor opens the file and maps all of it read-only
+    MappedFile(const string &path) : path(path), mapping(NULL), data(NULL), length(0), padding(0) {
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+            return;
+        length = size.QuadPart;
+        if (length == 0) {
+            data = ""; // An empty file cannot be mapped
+            return;
+        }
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL)
+            return;
+        data = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+        // The system fills the rest of the last page with zeros
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        padding = (info.dwPageSize - length % info.dwPageSize) % info.dwPageSize;
+    }
+
+    // Check if the file was opened and mapped
+    bool isOpen() const {
+        return data != NULL;
+    }
+
+    // Destructor to unmap the view and close the handles
+    ~MappedFile() {
+        if (mapping != NULL) {
+            if (data != NULL)
+                UnmapViewOfFile(data);
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+    }
+};
+
+// terminals of a grammar compiled for the lexer, built once per terminal set and shared through lexerSpecFor.
+// Terminals shaped like identifiers become keywords; the others are matched by a trie when they start with a symbol.
+struct LexerSpec {
+    set<string> terminals; // Terminals of the grammar, owning the strings the word table refers to
+    vector<array<short, 256>> trie; // Child of every trie node by next byte, 0 for none; node 0 is the root
+    vector<short> trieKinds; // Kind of the terminal ending at every trie node, -1 for none
+    unordered_map<string_view, short> words; // Kind of every terminal shaped like an identifier
+    bool declared[MAX_TOKEN_KINDS]; // Kinds the grammar declares, including the end of input
 
-    // Remove a token with the specified value from the symbol table
-    bool remove(string value) {
-        SymbolTable *current = this;
-        SymbolTable *prev = NULL;
-
-        while (current != NULL) {
-            if (current->token.value == value) {
-                if (prev == NULL) {
-                    // Handle removal from the first node
-                    if (current->next != NULL) {
-                        token = current->next->token;
-                        SymbolTable *temp = current->next;
-                        next = current->next->next;
-                        delete temp;
-                    } else {
-                        token = Token();
-                        next = NULL;
-                    }
-                } else {
-                    // Link the previous node to the next node, skipping the current node
-                    prev->next = current->next;
-                    delete current;
+    // Constructor registers the kinds of the terminals and builds the trie and the word table
+    LexerSpec(const set<string> &terms) : terminals(terms), trie(1), trieKinds(1, -1) {
+        fill(declared, declared + MAX_TOKEN_KINDS, false);
+        trie[0].fill(0);
+        declared[T_END] = true;
+        for (const string &name : terminals) {
+            short kind = tokenKindOf(name);
+            if (kind == -1)
+                continue; // No kind left, so the lexer never produces this terminal
+            declared[kind] = true;
+            if (kind < T_IF)
+                continue; // End marker and the token classes scanned by the DFA
+            if (isWord(name)) {
+                words[name] = kind;
+                continue;
+            }
+            int node = 0;
+            for (unsigned char ch : name) {
+                if (trie[node][ch] == 0) {
+                    trie[node][ch] = trie.size();
+                    trie.emplace_back();
+                    trie.back().fill(0);
+                    trieKinds.push_back(-1);
                 }
-                return true;
+                node = trie[node][ch];
             }
-            prev = current;
-            current = current->next;
+            trieKinds[node] = kind;
         }
-        return false;
     }
 
-    // Search for a token by its type and return a pointer to it
-    Token* searchType(string type) {
-        SymbolTable *current = this;
-        while (current != NULL) {
-            if (current->token.type == type)
-                return &current->token;
-            current = current->next;
+    // Check if a terminal is shaped like an identifier
+    static bool isWord(const string &name) {
+        const char *end = name.data() + name.length();
+        for (const char *p = name.data(); p < end;) {
+            bool first = p == name.data();
+            unsigned char ch = *p;
+            if (ch >= 0x80) {
+                // Non-ASCII characters must be identifier characters of Unicode
+                unsigned int codePoint;
+                if (utf8SequenceLength(p, end) == 0)
+                    return false;
+                p += decodeUtf8(p, codePoint);
+                if (!(first ? isXidStart(codePoint) : isXidContinue(codePoint)))
+                    return false;
+                continue;
+            }
+            if (charClass[ch] != C_LETTER && charClass[ch] != C_E && charClass[ch] != C_UNDERSCORE && (charClass[ch] != C_DIGIT || first))
+                return false;
+            p++;
         }
-        return NULL;
+        return true;
     }
 
-    // Search for a token by its value and return a pointer to it
-    Token* searchValue(string value) {
-        SymbolTable *current = this;
-        while (current != NULL) {
-            if (current->token.value == value)
-                return &current->token;
-            current = current->next;
+    // Length of the longest symbolic terminal starting at p and its kind, or 0 if none; end bounds the read
+    int matchSymbol(const char *p, const char *end, short &kind) const {
+        int node = 0, matched = 0;
+        for (int i = 0; p + i < end; i++) {
+            node = trie[node][(unsigned char)p[i]];
+            if (node == 0)
+                break;
+            if (trieKinds[node] != -1) {
+                matched = i + 1;
+                kind = trieKinds[node];
+            }
         }
-        return NULL;
+        return matched;
     }
 
-    // Destructor to clean up the linked list
-    ~SymbolTable() {
-        SymbolTable *current = next;
-        while (current != NULL) {
-            SymbolTable *temp = current->next;
-            current->next = NULL;
-            delete current;
-            current = temp;
-        }
-        count--;
+    // Kind of a word, or T_ID if the grammar has no such keyword
+    short wordKind(string_view word) const {
+        auto it = words.find(word);
+        return it == words.end() ? T_ID : it->second;
     }
 };
-int SymbolTable::count = 0;
+
+// Lexer spec of a terminal set, built on first use and kept until the program ends
+inline const LexerSpec *lexerSpecFor(const set<string> &terms) {
+    static map<set<string>, unique_ptr<LexerSpec>> lexerSpecs; // Lexer specs of the grammars seen so far, by terminal set
+    unique_ptr<LexerSpec> &spec = lexerSpecs[terms];
+    if (spec == NULL)
+        spec.reset(new LexerSpec(terms));
+    return spec.get();
+}
 
 // Lexer, Handles lexical analysis
 struct Lexer {
     SymbolTable &table; // Reference to the symbol table for token management
-    string input; // The input string being processed
-    int pos; // Current position in the input string
+    const char *input; // The input being processed, followed by padding zero bytes for vector loads
+    long long length; // Length of the input held in memory
+    long long padding; // Number of readable zero bytes after the input
+    char *buffer; // Owned buffer of a string or stream input, NULL for a mapped file
+    MappedFile *file; // Mapped file holding the input, or NULL if the lexer owns its buffer
+    istream *stream; // Stream the input is read from in chunks, or NULL
+    int fd; // File descriptor the input is read from in chunks, or -1
+    long long capacity; // Size of the stream window, without its padding
+    long long base; // Offset of input[0] from the start of the whole input, nonzero only for streams
+    bool exhausted; // True once all of the input is in memory
+    TokenBuffer *replay; // Tokens returned instead of scanning the input, or NULL
+    long long replayNext; // Index of the next token to replay
+    vector<long long> lineStarts; // Offsets of the first character of every line indexed so far, from the line holding the stream window
+    long long firstLine; // Line number of lineStarts[0], above 1 once a stream window has dropped lines
+    long long indexed; // Offset up to which the newlines of the input are indexed
+    const LexerSpec *spec; // Terminals of the grammar being parsed, or NULL for the built-in operators and keywords
+    short terminalKind; // Kind of the grammar terminal matched by the last scan
+    long long validFrom, validTo; // Range of the whole input last found to be valid UTF-8 by the vectorized validator
+    long long pos; // Current position in the whole input
 
     // Constructor initializes the lexer with a symbol table and input string
-    Lexer(SymbolTable &t, const string input) : table(t), input(input), pos(0) {
-        // Insert predefined tokens into the symbol table
-        table.insert({"if"});
-        table.insert({"else"});
-        table.insert({"true"});
-        table.insert({"false"});
-        table.insert({"and"});
-        table.insert({"or"});
-        table.insert({"not"});
-        table.insert({"int"});
-        table.insert({"float"});
-    }
-
-    // Get the next token from the input string
+    Lexer(SymbolTable &t, const string &input) : table(t), length(input.length()), padding(LEXER_PADDING), file(NULL), stream(NULL), fd(-1), capacity(0), base(0), exhausted(true), replay(NULL), replayNext(0), lineStarts(1, 0), firstLine(1), indexed(0), spec(NULL), terminalKind(T_END), validFrom(0), validTo(0), pos(0) {
+        // Copy the input into a zero-padded buffer
+        buffer = new char[length + LEXER_PADDING]();
+        memcpy(buffer, input.data(), length);
+        this->input = buffer;
+    }
+
+    // Constructor lexes a mapped file in place and takes ownership of the mapping
+    Lexer(SymbolTable &t, MappedFile *file) : table(t), input(file->data), length(file->length), padding(file->padding), buffer(NULL), file(file), stream(NULL), fd(-1), capacity(0), base(0), exhausted(true), replay(NULL), replayNext(0), lineStarts(1, 0), firstLine(1), indexed(0), spec(NULL), terminalKind(T_END), validFrom(0), validTo(0), pos(0) {}
+
+    // Constructor lexes the slice [from, to) of another lexer's input in place, keeping the offsets of the whole input
+    Lexer(SymbolTable &t, const Lexer &whole, long long from, long long to) : table(t), input(whole.input + (from - whole.base)), length(to - from), padding(whole.length + whole.padding - (to - whole.base)), buffer(NULL), file(NULL), stream(NULL), fd(-1), capacity(0), base(from), exhausted(true), replay(NULL), replayNext(0), lineStarts(1, 0), firstLine(1), indexed(0), spec(whole.spec), terminalKind(T_END), validFrom(0), validTo(0), pos(from) {}
+
+    // Constructor lexes a stream lazily, holding only a window of chunkSize bytes in memory
+    Lexer(SymbolTable &t, istream &stream, int chunkSize = LEXER_CHUNK_SIZE) : table(t), length(0), padding(LEXER_PADDING), file(NULL), stream(&stream), fd(-1), capacity(chunkSize), base(0), exhausted(false), replay(NULL), replayNext(0), lineStarts(1, 0), firstLine(1), indexed(0), spec(NULL), terminalKind(T_END), validFrom(0), validTo(0), pos(0) {
+        buffer = new char[capacity + LEXER_PADDING]();
+        input = buffer;
+    }
+
+    // Constructor lexes a file descriptor such as a pipe lazily, holding only a window of chunkSize bytes in memory
+    Lexer(SymbolTable &t, int fd, int chunkSize = LEXER_CHUNK_SIZE) : table(t), length(0), padding(LEXER_PADDING), file(NULL), stream(NULL), fd(fd), capacity(chunkSize), base(0), exhausted(false), replay(NULL), replayNext(0), lineStarts(1, 0), firstLine(1), indexed(0), spec(NULL), terminalKind(T_END), validFrom(0), validTo(0), pos(0) {
+        buffer = new char[capacity + LEXER_PADDING]();
+        input = buffer;
+    }
+
+    // Read up to size bytes of the stream or file descriptor, returning the number of bytes read
+    long long readChunk(char *dest, long long size) {
+        if (stream != NULL) {
+            stream->read(dest, size);
+            return stream->gcount();
+        }
+        int count = _read(fd, dest, size);
+        return count > 0 ? count : 0;
+    }
+
+    // Drop the window before offset keep and append the next chunk of the stream to the rest
+    void refill(long long keep) {
+        dropLines(keep); // The dropped bytes can no longer be indexed later
+        long long kept = length - (keep - base); // Bytes of the window still needed
+        memmove(buffer, buffer + (keep - base), kept);
+        base = keep;
+        if (kept == capacity) {
+            // A single lexeme fills the whole window, so double it
+            char *larger = new char[capacity * 2 + LEXER_PADDING];
+            memcpy(larger, buffer, kept);
+            delete[] buffer;
+            buffer = larger;
+            capacity *= 2;
+        }
+        long long count = readChunk(buffer + kept, capacity - kept);
+        if (count == 0)
+            exhausted = true;
+        length = kept + count;
+        memset(buffer + length, 0, LEXER_PADDING); // Restore the zero padding after the new end
+        input = buffer;
+    }
+
+    // Get the next token from the input by running the lexer DFA
     Token getNextToken() {
+        if (replay != NULL) {
+            // Return the saved token, staying on the end token once it is reached
+            Token token = replay->at(replayNext);
+            if (token.kind != T_END)
+                replayNext++;
+            pos = token.start + token.length;
+            return token;
+        }
+
+        long long start; // Offset of the lexeme being scanned
+        int action = scanNext(start);
+        return makeToken(action, start);
+    }
+
+    // Scan the next lexeme like scan, refilling the window of a stream when the lexeme may continue past it
+    int scanNext(long long &start) {
+        int action = scan(start);
+
+        // A lexeme reaching the end of a stream window may continue in the next chunk, so scan it again after a refill
+        while (!exhausted && pos - base >= length) {
+            refill(start);
+            pos = start;
+            action = scan(start);
+        }
+        return action;
+    }
+
+    // Run the lexer DFA over the next lexeme, leave its offset in start and the offset after it in pos, and return the final action
+    int scan(long long &start) {
+        const char *end = input + length + padding; // End of the readable memory
+
+        // Skip whitespace characters to locate the next meaningful token
+        long long at = skipSpaces(input + (pos - base), end) - input; // Position in the input buffer
+        start = base + at;
+
+        // Check if the end of the input is reached
+        if (at >= length) {
+            pos = start;
+            return A_END;
+        }
+
+        const unsigned char *text = (const unsigned char *)input;
+        int state = S_START;
+        int next = A_END;
+        int cls = charClass[text[at]];
+        if (cls == C_LETTER || cls == C_E || cls == C_UNDERSCORE) {
+            // Identifiers only loop in S_ID, so skip the whole run at once
+            at = skipIdentifier(input + at + 1, end) - input;
+            if (at < length && text[at] >= 0x80) // A mapped file may end exactly at its last page with no padding
+                at = skipUnicodeIdentifier(at, end);
+            next = A_ID;
+        } else {
+            int matched = 0; // Length of the longest grammar terminal at the start of the token
+            if (spec != NULL) {
+                // Symbolic terminals of the grammar take the longest match in its trie, numbers only when they are not longer
+                matched = spec->matchSymbol(input + at, input + length, terminalKind);
+                if (matched > 0 && cls != C_DIGIT) {
+                    pos = base + at + matched;
+                    return A_TERMINAL;
+                }
+            }
+            if (text[at] >= 0x80) {
+                // Characters beyond ASCII are decoded as UTF-8
+                next = scanUnicode(at, end);
+                pos = base + at;
+                return next;
+            }
+            if (cls == C_DIGIT) {
+                // Skip the integer part of a number at once
+                at = skipDigits(input + at + 1, end) - input;
+                state = S_INT;
+            }
+            // Run the DFA until it reaches a final action; the end of the input acts like any other character
+            while (at < length && (next = transitions[state][charClass[text[at]]]) < A_ID) {
+                state = next;
+                at++;
+            }
+            if (at == length)
+                next = transitions[state][C_OTHER];
+            if (matched > 0 && base + at - start <= matched) {
+                // A terminal made of digits, such as "1", wins over a number of the same length
+                pos = start + matched;
+                return A_TERMINAL;
+            }
+        }
+        pos = base + at;
+        return next;
+    }
+
+    // Length of the UTF-8 sequence at a position of the buffer and its code point, or 0 if it is not valid UTF-8.
+    // The input is validated ahead by the lookup-table validator, 16 or 32 bytes per step with SSSE3 or AVX2, the first time
+    // a non-ASCII byte is met past the range found valid before, so ASCII input never runs it and the sequences inside the
+    // range are decoded unchecked.
+    int utf8At(long long at, unsigned int &codePoint) {
+        long long offset = base + at;
+        if (offset < validFrom || offset >= validTo) {
+            validFrom = offset;
+            validTo = base + (validateUtf8(input + at, input + length) - input);
+            if (validTo == offset)
+                return 0;
+        }
+        return decodeUtf8(input + at, codePoint);
+    }
+
+    // Check if a sequence that is not valid UTF-8 may only be cut off by the end of a stream window
+    bool cutOffUtf8(long long at) {
+        return !exhausted && length - at < 4;
+    }
+
+    // Skip the rest of an identifier that continues with non-ASCII characters, returning the position after it
+    long long skipUnicodeIdentifier(long long at, const char *end) {
+        unsigned int codePoint;
+        while (at < length && (unsigned char)input[at] >= 0x80) {
+            int sequence = utf8At(at, codePoint);
+            if (sequence == 0 && cutOffUtf8(at))
+                return length; // Scan the identifier again once the next chunk is read
+            if (sequence == 0 || !isXidContinue(codePoint))
+                break;
+            at = skipIdentifier(input + at + sequence, end) - input;
+        }
+        return at;
+    }
+
+    // Scan a lexeme starting with a non-ASCII byte: an identifier, a character that is no identifier character,
+    // or a malformed UTF-8 sequence together with the continuation bytes after it
+    int scanUnicode(long long &at, const char *end) {
+        unsigned int codePoint;
+        int sequence = utf8At(at, codePoint);
+        if (sequence == 0) {
+            if (cutOffUtf8(at)) {
+                at = length; // Scan the sequence again once the next chunk is read
+                return A_INVALID_UTF8;
+            }
+            at++;
+            while (at < length && (input[at] & 0xC0) == 0x80)
+                at++;
+            return A_INVALID_UTF8;
+        }
+        if (!isXidStart(codePoint)) {
+            at += sequence;
+            return A_INVALID_CHAR;
+        }
+        at = skipIdentifier(input + at + sequence, end) - input;
+        if (at < length && (unsigned char)input[at] >= 0x80)
+            at = skipUnicodeIdentifier(at, end);
+        return A_ID;
+    }
+
+    // Build the token of a scanned lexeme, entering it into the symbol table
+    Token makeToken(int action, long long start) {
+        const char *text = input + (start - base); // First character of the lexeme
+        int result; // Symbol table handle of the token
+        switch (action) {
+            case A_END:
+                return {T_END, start};
+            case A_ID: {
+                // Keywords are recognized without the symbol table and get no entry
+                string_view id(text, pos - start);
+                short kind = spec != NULL ? spec->wordKind(id) : keywordKind(id);
+                if (kind != T_ID)
+                    return {kind, start, pos - start};
+                result = table.searchValue(id);
+                if (result == -1)
+                    result = table.insert(T_ID, id); // Insert new identifiers into the symbol table
+                table.at(result).uses++;
+                return {T_ID, start, pos - start, result};
+            }
+            case A_INT:
+            case A_FLOAT: {
+                string_view num(text, pos - start);
+                result = table.searchValue(num);
+                if (result != -1) {
+                    table.at(result).uses++;
+                    return {table.at(result).kind, start, pos - start, result};
+                }
+
+                // Decode a new literal once, reporting values that do not fit as lexical errors
+                long long intValue;
+                double floatValue;
+                short kind = action == A_INT ? decodeInt(num, intValue) : decodeFloat(num, floatValue);
+                if (kind != T_INT_NUM && kind != T_FLOAT_NUM)
+                    return {kind, start, pos - start};
+                result = table.insert(kind, num); // Insert number into the symbol table
+                table.at(result).constant = kind == T_INT_NUM ? table.constants.addInt(intValue) : table.constants.addFloat(floatValue);
+                table.at(result).uses++;
+                return {kind, start, pos - start, result};
+            }
+            case A_OPERATOR:
+            case A_TERMINAL: {
+                short kind = action == A_OPERATOR ? operatorKinds[(unsigned char)text[0]] : terminalKind;
+                result = table.searchType(tokenKinds[kind]);
+                if (result == -1)
+                    result = table.insert(kind); // Insert operator/punctuation into the symbol table if not present
+                table.at(result).uses++;
+                return {kind, start, pos - start, result};
+            }
+            case A_INVALID_NUM:
+                return {T_INVALID_NUM, start, pos - start};
+            case A_INVALID_ID:
+                return {T_INVALID_ID, start, pos - start};
+            case A_INVALID_UTF8:
+                return {T_INVALID_UTF8, start, pos - start};
+            default:
+                return {T_INVALID_CHAR, start, pos - start};
+        }
+    }
+
+    // Branch-chain scanner replaced by the DFA, kept as the baseline of the lexer benchmark.
+    // It relies on the zero byte after the input, so it only runs on string inputs.
+    Token getNextTokenReference() {
         // Skip whitespace characters to locate the next meaningful token
         while (isspace(input[pos]))
             pos++;
 
         // Check if the end of the input string is reached
-        if (pos >= input.length())
-            return {"$"};
+        if (pos >= length)
+            return {T_END, pos};
 
+        long long start = pos; // Offset of the lexeme being scanned
         char current = input[pos];
         if (isalpha(current) || current == '_') {
             // Handle identifiers and keywords starting with an alphabet
-            string id;
-            id += input[pos++];
+            pos++;
             while (isalnum(input[pos]) || input[pos] == '_')
-                id += input[pos++];
+                pos++;
+            string_view id(input + start, pos - start);
 
-            // Check if the identifier matches an existing token in the table
-            Token *result = table.searchType(id);
-            if (result == NULL) {
-                Token token("id", id);
-                result = table.searchValue(id);
-                if (result == NULL)
-                    table.insert(token); // Insert new identifiers into the symbol table
-                return token;
-            } else
-                return *result; // Return existing token if found
+            // Check if the identifier is a keyword
+            short kind = keywordKind(id);
+            if (kind != T_ID)
+                return {kind, start, pos - start};
+            int result = table.searchValue(id);
+            if (result == -1)
+                result = table.insert(T_ID, id); // Insert new identifiers into the symbol table
+            return {T_ID, start, pos - start, result};
         } else if (isdigit(current)) {
             // Handle numeric literals (integers and floating-point numbers)
-            string num;
-            bool flag = true; // Flag to distinguish between integer and float
-            num += input[pos++];
+            short kind = T_INT_NUM; // Kind of the literal, integer until a fraction is seen
+            pos++;
             while (isdigit(input[pos]))
-                num += input[pos++];
+                pos++;
             if (input[pos] == '.') {
-                flag = false; // Mark as floating-point number
-                num += input[pos++];
+                kind = T_FLOAT_NUM; // Mark as floating-point number
+                pos++;
                 if (isdigit(input[pos])) {
-                    num += input[pos++];
+                    pos++;
                     while (isdigit(input[pos]))
-                        num += input[pos++];
+                        pos++;
                 } else
-                    return {"invalid-num", num}; // Handle invalid floating-point format
+                    return {T_INVALID_NUM, start, pos - start}; // Handle invalid floating-point format
             }
             if (input[pos] == 'E' || input[pos] == 'e') {
                 // Handle scientific notation for numbers
-                num += input[pos++];
+                pos++;
                 if (input[pos] == '+' || input[pos] == '-')
-                    num += input[pos++];
+                    pos++;
                 if (isdigit(input[pos])) {
-                    num += input[pos++];
+                    pos++;
                     while (isdigit(input[pos]))
-                        num += input[pos++];
+                        pos++;
                 } else if (!isalpha(input[pos]))
-                    return {"invalid-num", num};
+                    return {T_INVALID_NUM, start, pos - start};
             }
             if (isalpha(input[pos]) || input[pos] == '_') {
                 // Handle invalid numeric format with trailing alphabets
-                num += input[pos++];
+                pos++;
                 while (isalnum(input[pos]))
-                    num += input[pos++];
-                return {"invalid-id", num};
+                    pos++;
+                return {T_INVALID_ID, start, pos - start};
             }
-            Token token("", num);
-            if (flag)
-                token.setType("intNum"); // Assign type as integer
-            else
-                token.setType("floatNum"); // Assign type as float
-            if (table.searchValue(num) == NULL)
-                table.insert(token); // Insert number into the symbol table
-            return token;
+            string_view num(input + start, pos - start);
+            int result = table.searchValue(num);
+            if (result == -1)
+                result = table.insert(kind, num); // Insert number into the symbol table
+            return {kind, start, pos - start, result};
         } else if (current == '+' || current == '-' || current == '*' || current == '/' || current == '(' || current == ')' || current == '=') {
             // Handle operators and punctuations
             pos++;
-            string s(1, current);
-            Token token(s);
-            if (table.searchType(s) == NULL)
-                table.insert(token); // Insert operator/punctuation into the symbol table if not present
-            return token;
+            string_view op(input + start, 1);
+            int result = table.searchType(op);
+            if (result == -1)
+                result = table.insert(operatorKind(current)); // Insert operator/punctuation into the symbol table if not present
+            return {table.at(result).kind, start, 1, result};
         } else {
             // Handle invalid or unrecognized characters
             pos++;
-            return {"invalid-char", string(1, current)};
+            return {T_INVALID_CHAR, start, 1};
         }
     }
 
-    // Get all tokens from the input as a single string
-    string getAllTokens() {
-        SymbolTable temp;
-        Lexer lexer(temp, input);
-        string allTokens, nextTokenType;
-        while (nextTokenType != "$") {
-            nextTokenType = lexer.getNextToken().type;
-            allTokens += nextTokenType + " ";
+    // Decode an integer literal, which may have an exponent; returns T_INT_NUM, or the error kind if it is no 64-bit integer
+    static short decodeInt(string_view text, long long &value) {
+        size_t e = text.find_first_of("eE");
+        const char *end = text.data() + (e == string_view::npos ? text.length() : e);
+        errc ec = from_chars(text.data(), end, value).ec;
+        if (ec == errc::result_out_of_range)
+            return T_OVERFLOW_NUM;
+        if (ec != errc())
+            return T_INVALID_NUM;
+        if (e == string_view::npos || value == 0)
+            return T_INT_NUM;
+
+        // Apply the exponent, which must keep the value integral and within range
+        const char *digits = end + 1;
+        bool negative = *digits == '-';
+        if (*digits == '+' || *digits == '-')
+            digits++;
+        int exponent = 0;
+        ec = from_chars(digits, text.data() + text.length(), exponent).ec;
+        if (ec == errc::result_out_of_range)
+            exponent = 1000; // Far beyond every 64-bit value either way
+        else if (ec != errc())
+            return T_INVALID_NUM;
+        for (int i = 0; i < exponent; i++) {
+            if (negative) {
+                if (value % 10 != 0)
+                    return T_INEXACT_NUM;
+                value /= 10;
+            } else {
+                if (value > LLONG_MAX / 10)
+                    return T_OVERFLOW_NUM;
+                value *= 10;
+            }
+        }
+        return T_INT_NUM;
+    }
+
+    // Decode a floating-point literal; returns T_FLOAT_NUM, or the error kind if it overflows or underflows a double
+    static short decodeFloat(string_view text, double &value) {
+        if (from_chars(text.data(), text.data() + text.length(), value).ec != errc::result_out_of_range)
+            return T_FLOAT_NUM;
+        // from_chars does not tell the two apart, so ask strtod on this rare path
+        return strtod(string(text).c_str(), NULL) == HUGE_VAL ? T_OVERFLOW_NUM : T_INEXACT_NUM;
+    }
+
+    // Map an operator or punctuation character to its token kind
+    static short operatorKind(char op) {
+        switch (op) {
+            case '+': return T_PLUS;
+            case '-': return T_MINUS;
+            case '*': return T_STAR;
+            case '/': return T_SLASH;
+            case '(': return T_LPAREN;
+            case ')': return T_RPAREN;
+            default: return T_ASSIGN;
         }
+    }
+
+    // Lexeme of a token, viewed in place in the input buffer; for a stream it stays valid until the next token is read
+    string_view lexeme(const Token &token) const {
+        return string_view(input + (token.start - base), token.length);
+    }
+
+    // Text of a token for messages, its lexeme or its type if it has none
+    string tokenText(const Token &token) const {
+        if (token.length == 0)
+            return token.type();
+        return string(lexeme(token));
+    }
+
+    // Scan the rest of the input in one pass, appending every token up to and including the end token.
+    // Without enterSymbols the symbol table is left untouched and the tokens get no handles.
+    void tokenizeAll(TokenBuffer &tokens, bool enterSymbols = true) {
+        long long start; // Offset of the lexeme being scanned
+        int action;
+        do {
+            action = scanNext(start);
+            if (enterSymbols)
+                tokens.push(makeToken(action, start));
+            else
+                tokens.push({tokenKind(action, start), start, pos - start});
+        } while (action != A_END);
+    }
+
+    // Tokenize the rest of a string or mapped input on several threads, giving the same tokens and symbol table as tokenizeAll
+    void tokenizeParallel(TokenBuffer &tokens, int threads) {
+        if (threads <= 1 || !exhausted || replay != NULL) {
+            tokenizeAll(tokens);
+            return;
+        }
+
+        // Cut the input into slices at whitespace characters, which no token can cross; the cuts are offsets in
+        // the whole input, so the window of an exhausted stream that no longer starts at offset 0 is cut correctly
+        long long last = base + length; // Whole-input offset of the end of the input
+        vector<long long> cuts(threads + 1);
+        cuts[0] = pos;
+        cuts[threads] = last;
+        for (int i = 1; i < threads; i++) {
+            long long cut = max(cuts[i - 1], pos + (last - pos) / threads * i);
+            while (cut < last && charClass[(unsigned char)input[cut - base]] != C_SPACE)
+                cut++;
+            cuts[i] = cut;
+        }
+
+        // Tokenize every slice with its own lexer and symbol table
+        vector<SymbolTable> tables(threads);
+        vector<TokenBuffer> slices(threads);
+        vector<thread> workers;
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back([this, &tables, &slices, &cuts, i]() {
+                Lexer slice(tables[i], *this, cuts[i], cuts[i + 1]);
+                slice.tokenizeAll(slices[i]);
+            });
+        }
+        for (int i = 0; i < threads; i++)
+            workers[i].join();
+
+        // Merge the symbol tables in slice order, which is the order a single lexer would insert the symbols in
+        vector<vector<int>> handles(threads); // Handle in this table of every entry of the slice tables
+        for (int i = 0; i < threads; i++) {
+            handles[i].resize(tables[i].size);
+            for (int h = 0; h < tables[i].size; h++) {
+                Symbol &symbol = tables[i].at(h);
+                int result = symbol.value.empty() ? table.searchType(symbol.type()) : table.searchValue(symbol.value);
+                if (result == -1) {
+                    result = table.insert(symbol.kind, symbol.value);
+                    if (symbol.kind == T_INT_NUM)
+                        table.at(result).constant = table.constants.addInt(tables[i].intValue(h));
+                    else if (symbol.kind == T_FLOAT_NUM)
+                        table.at(result).constant = table.constants.addFloat(tables[i].floatValue(h));
+                }
+                table.at(result).uses += symbol.uses;
+                handles[i][h] = result;
+            }
+        }
+
+        // Concatenate the slices in order with their handles remapped, keeping only the last end token
+        vector<long long> offsets(threads + 1);
+        offsets[0] = tokens.size;
+        for (int i = 0; i < threads; i++)
+            offsets[i + 1] = offsets[i] + slices[i].size - (i < threads - 1);
+        tokens.reserve(offsets[threads]);
+        workers.clear();
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back([&tokens, &slices, &handles, &offsets, i]() {
+                TokenBuffer &slice = slices[i];
+                long long at = offsets[i];
+                for (long long j = 0; at < offsets[i + 1]; j++, at++) {
+                    tokens.kinds[at] = slice.kinds[j];
+                    tokens.starts[at] = slice.starts[j];
+                    tokens.lengths[at] = slice.lengths[j];
+                    tokens.handles[at] = slice.handles[j] == -1 ? -1 : handles[i][slice.handles[j]];
+                }
+            });
+        }
+        for (int i = 0; i < threads; i++)
+            workers[i].join();
+        tokens.size = offsets[threads];
+        pos = last;
+    }
+
+    // Apply an edit that replaces removed bytes at offset with inserted text to the input and to its tokens.
+    // Only the tokens from the last token boundary before the edit are lexed again, until a new token starts
+    // where a token after the edit started with the same kind and length; from there on the old tokens are kept
+    // with their offsets moved. Symbols that no token refers to anymore are removed from the symbol table.
+    TokenEdit applyEdit(TokenBuffer &tokens, long long offset, long long removed, const string &inserted) {
+        if (!exhausted || base != 0 || tokens.size == 0)
+            return {-1, 0, 0}; // A stream window or a slice does not hold the whole input
+        offset = min(max(offset, 0LL), length);
+        removed = min(max(removed, 0LL), length - offset);
+        long long shift = (long long)inserted.length() - removed; // Move of the offsets after the edit
+
+        // Rebuild the input with the edit applied
+        long long editedLength = length + shift;
+        char *edited = new char[editedLength + LEXER_PADDING]();
+        memcpy(edited, input, offset);
+        memcpy(edited + offset, inserted.data(), inserted.length());
+        memcpy(edited + offset + inserted.length(), input + offset + removed, length - offset - removed);
+        delete[] buffer;
+        delete file;
+        file = NULL;
+        buffer = edited;
+        input = buffer;
+        length = editedLength;
+        padding = LEXER_PADDING;
+
+        // Keep the line starts before the edit, the later ones are indexed again on demand
+        lineStarts.erase(upper_bound(lineStarts.begin(), lineStarts.end(), offset), lineStarts.end());
+        indexed = min(indexed, offset);
+        validFrom = validTo = 0; // The edit may have made the input invalid UTF-8
+
+        // Find the first token that ends at or after the edit; the token before it is lexed again too,
+        // since the scan that ended it may have looked at the bytes up to the edit
+        long long low = 0, high = tokens.size - 1;
+        while (low < high) {
+            long long middle = (low + high) / 2;
+            if (tokens.starts[middle] + tokens.lengths[middle] < offset)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        long long first = max(low - 1, 0LL);
+
+        // Lex from there until the new tokens line up with the old ones again
+        TokenBuffer fresh;
+        long long old = first; // First old token that may still line up with a new one
+        long long resumeAt = offset + inserted.length(); // Offset in the edited input from which the old tokens can line up
+        long long start; // Offset of the lexeme being scanned
+        pos = first == 0 ? 0 : tokens.starts[first]; // The edit may also come before the first token
+        while (true) {
+            int action = scanNext(start);
+            if (start >= resumeAt) {
+                while (old < tokens.size && (tokens.starts[old] < offset + removed || tokens.starts[old] + shift < start))
+                    old++;
+                if (old < tokens.size && tokens.starts[old] + shift == start && tokens.lengths[old] == pos - start && tokens.kinds[old] == tokenKind(action, start))
+                    break; // The rest of the stream is unchanged
+            }
+            fresh.push(makeToken(action, start));
+            if (action == A_END) {
+                old = tokens.size;
+                break;
+            }
+        }
+
+        // Drop the references of the replaced tokens and remove the symbols left without any
+        for (long long i = first; i < old; i++) {
+            int handle = tokens.handles[i];
+            if (handle != -1 && --table.at(handle).uses == 0)
+                table.removeAt(handle);
+        }
+        tokens.splice(first, old - first, fresh, shift);
+        pos = length;
+        replayNext = 0;
+        return {first, old - first, fresh.size};
+    }
+
+    // Kind of a scanned lexeme, found without changing the symbol table
+    short tokenKind(int action, long long start) {
+        switch (action) {
+            case A_END:
+                return T_END;
+            case A_ID: {
+                string_view id(input + (start - base), pos - start);
+                return spec != NULL ? spec->wordKind(id) : keywordKind(id);
+            }
+            case A_INT: {
+                long long intValue;
+                return decodeInt(string_view(input + (start - base), pos - start), intValue);
+            }
+            case A_FLOAT: {
+                double floatValue;
+                return decodeFloat(string_view(input + (start - base), pos - start), floatValue);
+            }
+            case A_OPERATOR:
+                return operatorKinds[(unsigned char)input[start - base]];
+            case A_TERMINAL:
+                return terminalKind;
+            case A_INVALID_NUM:
+                return T_INVALID_NUM;
+            case A_INVALID_ID:
+                return T_INVALID_ID;
+            case A_INVALID_UTF8:
+                return T_INVALID_UTF8;
+            default:
+                return T_INVALID_CHAR;
+        }
+    }
+
+    // Lex with the terminals of a grammar from now on, so every terminal it declares is recognized
+    void useTerminals(const set<string> &terms) {
+        spec = lexerSpecFor(terms);
+    }
+
+    // Lex with a lexer spec resolved beforehand, as a compiled grammar keeps it
+    void useTerminals(const LexerSpec *terminals) {
+        spec = terminals;
+    }
+
+    // Check if a token kind is a terminal of the grammar being parsed
+    bool isTerminal(short kind) const {
+        return spec != NULL && spec->declared[kind];
+    }
+
+    // Replay saved tokens of this input instead of scanning it, to time the parsers without the lexer
+    void replayTokens(TokenBuffer *tokens) {
+        replay = tokens;
+        replayNext = 0;
+    }
+
+    // Record the line starts of the input up to an offset; runs only when a position is resolved
+    void indexNewlines(long long offset) {
+        offset = min(offset, base + length);
+        while (indexed < offset) {
+            const char *from = input + (indexed - base);
+            const char *newline = (const char *)memchr(from, '\n', offset - indexed);
+            if (newline == NULL) {
+                indexed = offset;
+                break;
+            }
+            indexed += newline - from + 1;
+            lineStarts.push_back(indexed);
+        }
+    }
+
+    // Count the lines that end in the bytes a stream window drops before an offset, keeping only the start of the
+    // line that holds the offset, so a stream needs memory for the line starts of its current window alone
+    void dropLines(long long offset) {
+        long long lineStart = lineStarts.back(); // Start of the last line found so far
+        firstLine += lineStarts.size() - 1;
+        while (indexed < offset) {
+            const char *from = input + (indexed - base);
+            const char *newline = (const char *)memchr(from, '\n', offset - indexed);
+            if (newline == NULL) {
+                indexed = offset;
+                break;
+            }
+            indexed += newline - from + 1;
+            lineStart = indexed;
+            firstLine++;
+        }
+        lineStarts.assign(1, lineStart);
+    }
+
+    // Line and column of an offset in the input, found by binary search over the line starts
+    SourcePosition position(long long offset) {
+        indexNewlines(offset);
+        long long line = max<long long>(upper_bound(lineStarts.begin(), lineStarts.end(), offset) - lineStarts.begin(), 1); // Lines started up to offset
+        return {firstLine + line - 1, offset - lineStarts[line - 1] + 1};
+    }
+
+    // Location of an offset for diagnostics
+    string location(long long offset) {
+        SourcePosition at = position(offset);
+        return "Line number: [" + to_string(at.line) + "], Column number: [" + to_string(at.column) + "]";
+    }
+
+    // Get all tokens of a string or mapped input as a single string, without moving the lexer
+    string getAllTokens() {
+        long long saved = pos;
+        pos = 0;
+        TokenBuffer tokens;
+        tokenizeAll(tokens, false);
+        pos = saved;
+
+        string allTokens;
+        for (long long i = 0; i < tokens.size; i++)
+            allTokens += tokenKinds[tokens.kinds[i]] + " ";
         allTokens.pop_back(); // Remove trailing space
         return allTokens;
     }
+
+    // Destructor to release the input buffer or the mapped file
+    ~Lexer() {
+        delete[] buffer;
+        delete file;
+    }
 };
 
 // Display the contents of the symbol table
@@ -244,7 +1406,7 @@ void printSymbolTable(SymbolTable *table) {
         cout << "\n\n\n\n\t\t\t\t--------------------------------------------------------" << endl << endl;
         cout << "\t\t\t\t[#] Symbol Table [#]\n\n";
 
-        int rows = SymbolTable::count + 1;
+        int rows = table->count + 1;
         int cols = 3;
         int width = 30;
         string data[rows][cols];
@@ -252,22 +1414,24 @@ void printSymbolTable(SymbolTable *table) {
         data[0][1] = "Type";
         data[0][2] = "Attribute Value";
 
-        SymbolTable *current = table;
+        int handle = 0;
         for (int i = 1; i < rows; i++) {
+            while (table->removed[handle])
+                handle++; // Skip removed entries
+            Symbol &symbol = table->at(handle++);
             for (int j = 0; j < cols; j++) {
                 if (j == 0)
                     data[i][j] = to_string(i);
                 else if (j == 1) {
-                    data[i][j] = current->token.type;
+                    data[i][j] = symbol.type();
                 }
                 else {
-                    if (current->token.value.empty())
+                    if (symbol.value.empty())
                         data[i][j] = "N/A";
                     else
-                        data[i][j] = current->token.value;
+                        data[i][j] = string(symbol.value);
                 }
             }
-            current = current->next;
         }
 
         cout << "\t\t\t\t " << setfill((char)205) << setw(width*cols+cols-1) << (char)205 << endl;
@@ -0,0 +1,282 @@
+
+// Vectorized kernels that find the end of a whitespace, identifier or digit run, and a UTF-8 validator.
+// Every kernel reads whole 16 or 32 byte blocks while they fit before end, the end of
+// the readable memory, and finishes the last few bytes one at a time. A zero byte ends
+// every skipped run, so a buffer followed by LEXER_PADDING zero bytes never leaves the vector loop.
+
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define COUNT_TRAILING_ZEROS(mask) __builtin_ctz(mask)
+
+// Scalar kernels, used when the processor has no vector extension we support
+const char *skipSpacesScalar(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || (unsigned char)(*p - '\t') <= '\r' - '\t'))
+        p++;
+    return p;
+}
+
+const char *skipIdentifierScalar(const char *p, const char *end) {
+    while (p < end && ((unsigned char)((*p | 0x20) - 'a') <= 'z' - 'a' || (unsigned char)(*p - '0') <= 9 || *p == '_'))
+        p++;
+    return p;
+}
+
+const char *skipDigitsScalar(const char *p, const char *end) {
+    while (p < end && (unsigned char)(*p - '0') <= 9)
+        p++;
+    return p;
+}
+
+// Validate UTF-8, returning the first byte of the first invalid sequence or end
+const char *validateUtf8Scalar(const char *p, const char *end) {
+    while (p < end) {
+        int length = utf8SequenceLength(p, end);
+        if (length == 0)
+            return p;
+        p += length;
+    }
+    return p;
+}
+
+// Check the run of multi-byte sequences starting at p, returning the first ASCII byte after it or the first invalid byte
+const char *validateUtf8Run(const char *p, const char *end, bool &valid) {
+    while (p < end && (unsigned char)*p >= 0x80) {
+        int length = utf8SequenceLength(p, end);
+        if (length == 0) {
+            valid = false;
+            return p;
+        }
+        p += length;
+    }
+    valid = true;
+    return p;
+}
+
+// First byte of the sequence holding the byte at p, given that every sequence before p from begin is valid
+const char *utf8SequenceStart(const char *begin, const char *p) {
+    if (p == begin)
+        return p;
+    const char *lead = p - 1;
+    while (lead > begin && p - lead < 4 && ((unsigned char)*lead & 0xC0) == 0x80)
+        lead--;
+    unsigned char c = *lead;
+    int length = c < 0x80 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+    return lead + length > p ? lead : p;
+}
+
+// Error flags of the lookup-table UTF-8 validator of Keiser and Lemire. Every byte and the byte before it look up
+// the errors allowed by the high nibble of the first, the low nibble of the first and the high nibble of the second,
+// and an error is left only where all three tables agree
+#define UTF8_TOO_SHORT 0x01 // Lead byte followed by a byte that is no continuation byte
+#define UTF8_TOO_LONG 0x02 // Continuation byte after an ASCII byte
+#define UTF8_OVERLONG_3 0x04 // E0 followed by 80 to 9F
+#define UTF8_TOO_LARGE 0x08 // F4 followed by 90 to BF, or F5 to FF
+#define UTF8_SURROGATE 0x10 // ED followed by A0 to BF
+#define UTF8_OVERLONG_2 0x20 // C0 or C1
+#define UTF8_TOO_LARGE_1000 0x40 // F5 to FF followed by 80 to 8F
+#define UTF8_OVERLONG_4 0x40 // F0 followed by 80 to 8F
+#define UTF8_TWO_CONTS 0x80 // Continuation byte after a continuation byte, only allowed as the 3rd or 4th byte
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS) // Errors decided by the high nibble alone
+
+// Tables of the validator, indexed by the high nibble of a byte, its low nibble, and the high nibble of the byte after it
+#define UTF8_BYTE_1_HIGH \
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, \
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TOO_SHORT | UTF8_OVERLONG_2, UTF8_TOO_SHORT, \
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE, UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4
+#define UTF8_BYTE_1_LOW \
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4, UTF8_CARRY | UTF8_OVERLONG_2, UTF8_CARRY, UTF8_CARRY, \
+    UTF8_CARRY | UTF8_TOO_LARGE, UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE, UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000
+#define UTF8_BYTE_2_HIGH \
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, \
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4, \
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE, \
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE, \
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE, \
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT
+
+#if SIMD_SCANNER
+// Unsigned test lo <= v <= hi on every byte, done as (v - lo) == min(v - lo, hi - lo)
+#define SSE2_IN_RANGE(v, lo, hi) _mm_cmpeq_epi8(_mm_min_epu8(_mm_sub_epi8(v, _mm_set1_epi8(lo)), _mm_set1_epi8((hi) - (lo))), _mm_sub_epi8(v, _mm_set1_epi8(lo)))
+#define AVX2_IN_RANGE(v, lo, hi) _mm256_cmpeq_epi8(_mm256_min_epu8(_mm256_sub_epi8(v, _mm256_set1_epi8(lo)), _mm256_set1_epi8((hi) - (lo))), _mm256_sub_epi8(v, _mm256_set1_epi8(lo)))
+
+// SSE2 kernels, 16 bytes per step
+TARGET_SSE2 const char *skipSpacesSSE2(const char *p, const char *end) {
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i match = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), SSE2_IN_RANGE(v, '\t', '\r'));
+        unsigned int mask = ~_mm_movemask_epi8(match) & 0xFFFF; // Bytes that end the run
+        if (mask)
+            return p + COUNT_TRAILING_ZEROS(mask);
+        p += 16;
+    }
+    return skipSpacesScalar(p, end);
+}
+
+TARGET_SSE2 const char *skipIdentifierSSE2(const char *p, const char *end) {
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i letter = SSE2_IN_RANGE(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+        __m128i match = _mm_or_si128(_mm_or_si128(letter, SSE2_IN_RANGE(v, '0', '9')), _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+        unsigned int mask = ~_mm_movemask_epi8(match) & 0xFFFF;
+        if (mask)
+            return p + COUNT_TRAILING_ZEROS(mask);
+        p += 16;
+    }
+    return skipIdentifierScalar(p, end);
+}
+
+TARGET_SSE2 const char *skipDigitsSSE2(const char *p, const char *end) {
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        unsigned int mask = ~_mm_movemask_epi8(SSE2_IN_RANGE(v, '0', '9')) & 0xFFFF;
+        if (mask)
+            return p + COUNT_TRAILING_ZEROS(mask);
+        p += 16;
+    }
+    return skipDigitsScalar(p, end);
+}
+
+// Without a byte shuffle SSE2 cannot look up the tables, so blocks of ASCII bytes are skipped whole
+// and only the sequences of the other blocks are checked one by one; it runs on processors without SSSE3
+TARGET_SSE2 const char *validateUtf8SSE2(const char *p, const char *end) {
+    bool valid;
+    while (end - p >= 16) {
+        unsigned int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)p)); // Bytes with the high bit set
+        if (mask == 0) {
+            p += 16;
+            continue;
+        }
+        p = validateUtf8Run(p + COUNT_TRAILING_ZEROS(mask), end, valid);
+        if (!valid)
+            return p;
+    }
+    return validateUtf8Scalar(p, end);
+}
+
+// SSSE3 validator, 16 bytes per step with the tables looked up by byte shuffles. A block with an error
+// is checked again one sequence at a time to find the first invalid byte
+TARGET_SSSE3 const char *validateUtf8SSSE3(const char *p, const char *end) {
+    const char *begin = p;
+    __m128i byte1High = _mm_setr_epi8(UTF8_BYTE_1_HIGH);
+    __m128i byte1Low = _mm_setr_epi8(UTF8_BYTE_1_LOW);
+    __m128i byte2High = _mm_setr_epi8(UTF8_BYTE_2_HIGH);
+    __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i previous = _mm_setzero_si128(); // Block before the current one, zero before the first
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i prev1 = _mm_alignr_epi8(v, previous, 15); // Byte before every byte
+        __m128i special = _mm_and_si128(_mm_and_si128(
+                _mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, nibble))),
+                _mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+        // Bytes that must be the 3rd or 4th of a sequence, as E0 or more two bytes back or F0 or more three bytes back
+        __m128i third = _mm_subs_epu8(_mm_alignr_epi8(v, previous, 14), _mm_set1_epi8(0xE0 - 0x80));
+        __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(v, previous, 13), _mm_set1_epi8(0xF0 - 0x80));
+        __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(0x80));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_xor_si128(must23, special), _mm_setzero_si128())) != 0xFFFF)
+            break;
+        previous = v;
+        p += 16;
+    }
+    return validateUtf8Scalar(utf8SequenceStart(begin, p), end);
+}
+
+// AVX2 kernels, 32 bytes per step
+TARGET_AVX2 const char *skipSpacesAVX2(const char *p, const char *end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        __m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), AVX2_IN_RANGE(v, '\t', '\r'));
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(match);
+        if (mask)
+            return p + COUNT_TRAILING_ZEROS(mask);
+        p += 32;
+    }
+    return skipSpacesScalar(p, end);
+}
+
+TARGET_AVX2 const char *skipIdentifierAVX2(const char *p, const char *end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        __m256i letter = AVX2_IN_RANGE(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+        __m256i match = _mm256_or_si256(_mm256_or_si256(letter, AVX2_IN_RANGE(v, '0', '9')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(match);
+        if (mask)
+            return p + COUNT_TRAILING_ZEROS(mask);
+        p += 32;
+    }
+    return skipIdentifierScalar(p, end);
+}
+
+TARGET_AVX2 const char *skipDigitsAVX2(const char *p, const char *end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(AVX2_IN_RANGE(v, '0', '9'));
+        if (mask)
+            return p + COUNT_TRAILING_ZEROS(mask);
+        p += 32;
+    }
+    return skipDigitsScalar(p, end);
+}
+
+TARGET_AVX2 const char *validateUtf8AVX2(const char *p, const char *end) {
+    const char *begin = p;
+    __m256i byte1High = _mm256_setr_epi8(UTF8_BYTE_1_HIGH, UTF8_BYTE_1_HIGH);
+    __m256i byte1Low = _mm256_setr_epi8(UTF8_BYTE_1_LOW, UTF8_BYTE_1_LOW);
+    __m256i byte2High = _mm256_setr_epi8(UTF8_BYTE_2_HIGH, UTF8_BYTE_2_HIGH);
+    __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i previous = _mm256_setzero_si256();
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        __m256i shifted = _mm256_permute2x128_si256(previous, v, 0x21); // Last half of the previous block and first half of this one
+        __m256i prev1 = _mm256_alignr_epi8(v, shifted, 15);
+        __m256i special = _mm256_and_si256(_mm256_and_si256(
+                _mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, nibble))),
+                _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+        __m256i third = _mm256_subs_epu8(_mm256_alignr_epi8(v, shifted, 14), _mm256_set1_epi8(0xE0 - 0x80));
+        __m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(v, shifted, 13), _mm256_set1_epi8(0xF0 - 0x80));
+        __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(0x80));
+        if (!_mm256_testz_si256(_mm256_xor_si256(must23, special), _mm256_xor_si256(must23, special)))
+            break;
+        previous = v;
+        p += 32;
+    }
+    return validateUtf8Scalar(utf8SequenceStart(begin, p), end);
+}
+
+#endif
+
+// Kernels selected for this processor
+const char *(*skipSpaces)(const char *, const char *) = skipSpacesScalar;
+const char *(*skipIdentifier)(const char *, const char *) = skipIdentifierScalar;
+const char *(*skipDigits)(const char *, const char *) = skipDigitsScalar;
+const char *(*validateUtf8)(const char *, const char *) = validateUtf8Scalar;
+string simdKernel = "Scalar"; // Name of the selected kernel set
+
+// Pick the widest kernels the processor supports
+bool selectScanKernels() {
+#if SIMD_SCANNER
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        skipSpaces = skipSpacesAVX2;
+        skipIdentifier = skipIdentifierAVX2;
+        skipDigits = skipDigitsAVX2;
+        validateUtf8 = validateUtf8AVX2;
+        simdKernel = "AVX2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        skipSpaces = skipSpacesSSE2;
+        skipIdentifier = skipIdentifierSSE2;
+        skipDigits = skipDigitsSSE2;
+        validateUtf8 = __builtin_cpu_supports("ssse3") ? validateUtf8SSSE3 : validateUtf8SSE2;
+        simdKernel = "SSE2";
+    }
+#endif
+    return true;
+}
+bool scanKernelsSelected = selectScanKernels();
@@ -1,14 +1,32 @@
 #include <iostream>
 #include <iomanip>
 #include <windows.h>
+#include <io.h>
 #include <chrono>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
 #include <set>
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <stack>
 #include <algorithm>
+#include <cstring>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <thread>
+
+// Vector kernels of the lexer are only built for x86 processors
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_SCANNER 1
+#else
+#define SIMD_SCANNER 0
+#endif
 
 using namespace std;
 using namespace chrono;
@@ -26,15 +44,32 @@ void tic(time_point<high_resolution_clock>&);
 double toc(time_point<high_resolution_clock>);
 
 #define RUN 20
-#define MAX_GRAMMAR_SIZE 1000
 #define MAX_ERROR_SIZE 1000
 #define MAX_PROCESS_SIZE 1000
-
+#define MAX_TOKEN_KINDS 256
+#define BENCHMARK_INPUT_SIZE 8000000
+#define LEXER_PADDING 64
+#define LEXER_CHUNK_SIZE 65536
+#define ARENA_BLOCK_SIZE 65536
+#define TOKEN_BUFFER_FILE "tokens.bin"
+#define BENCHMARK_GRAMMAR_SIZE 100000
+#define BENCHMARK_GRAMMAR_FILE "benchmark_grammar.txt"
+#define BENCHMARK_NONTERMINALS 8000
+#define GRAMMAR_CACHE_VERSION 6
+#define LR_ACCEPT INT_MAX
+#define LR_ERROR INT_MIN
+
+#include "Unicode.hpp"
+#include "SimdScanner.hpp"
 #include "Lexer.hpp"
+#include "GrammarCache.hpp"
+#include "Grammar.hpp"
+#include "GrammarSets.hpp"
 #include "RecursiveDescentParser.hpp"
 #include "LL1Parser.hpp"
 #include "LR1Parser.hpp"
 #include "LALR1Parser.hpp"
+#include "Benchmark.hpp"
 
 // Display the main menu
 int Menu();
@@ -48,15 +83,20 @@ void loading();
 int main() {
     SymbolTable *table;
     Lexer *lexer;
+    RecursiveDescentGrammar *RDGrammar;
     RecursiveDescentParser *RDParser;
+    LL1Grammar *TopDownGrammar;
     LL1Parser *TopDownParser;
+    LR1Grammar *BottomUpGrammar1;
     LR1Parser *BottomUpParser1;
+    LALR1Grammar *BottomUpGrammar2;
     LALR1Parser *BottomUpParser2;
 
     string inputString = "(xyz1+abc1)/(xyzkt2-ukm)"; // (xyz1+abc1)/(xyzkt2-ukm)
     fstream grammar_file;
     string path = "Grammars/";
     string inputGrammar = "g01.txt";
+    string sourceFile; // Path of the source file lexed by the memory-mapped lexer benchmark
 
     bool flag;
     while (1) {
@@ -66,7 +106,8 @@ int main() {
                 flag = true;
                 table = new SymbolTable;
                 lexer = new Lexer(*table, inputString);
-                RDParser = new RecursiveDescentParser(*lexer, path + inputGrammar);
+                RDGrammar = new RecursiveDescentGrammar(path + inputGrammar);
+                RDParser = new RecursiveDescentParser(*RDGrammar, *lexer, true); // Trace every step for the processing table
                 RDParser->parse();
                 while (flag) {
                     switch (RecursiveDescentMenu(*RDParser)) {
@@ -76,12 +117,11 @@ int main() {
                             cout << "\n\n\n\n\t\t\t\tPlease enter the input string: ";
                             cin.ignore();
                             getline(cin, inputString);
-                            delete RDParser;
                             delete lexer;
                             delete table;
                             table = new SymbolTable;
                             lexer = new Lexer(*table, inputString);
-                            RDParser = new RecursiveDescentParser(*lexer, path + inputGrammar);
+                            RDParser->reset(*lexer);
                             RDParser->parse();
                             loading();
                             break;
@@ -110,11 +150,13 @@ int main() {
                                 grammar_file.open(path + inputGrammar);
                             }
                             delete RDParser;
+                            delete RDGrammar;
                             delete lexer;
                             delete table;
                             table = new SymbolTable;
                             lexer = new Lexer(*table, inputString);
-                            RDParser = new RecursiveDescentParser(*lexer, path + inputGrammar);
+                            RDGrammar = new RecursiveDescentGrammar(path + inputGrammar);
+                            RDParser = new RecursiveDescentParser(*RDGrammar, *lexer, true); // Trace every step for the processing table
                             RDParser->parse();
                             loading();
                             break;
@@ -139,6 +181,7 @@ int main() {
 
                         case 0:
                             delete RDParser;
+                            delete RDGrammar;
                             delete lexer;
                             delete table;
                             flag = false;
@@ -158,7 +201,8 @@ int main() {
                 flag = true;
                 table = new SymbolTable;
                 lexer = new Lexer(*table, inputString);
-                TopDownParser = new LL1Parser(*lexer, path + inputGrammar);
+                TopDownGrammar = new LL1Grammar(path + inputGrammar);
+                TopDownParser = new LL1Parser(*TopDownGrammar, *lexer, true); // Trace every step for the processing table
                 TopDownParser->parse();
                 while (flag) {
                     switch (LL1Menu(*TopDownParser)) {
@@ -168,12 +212,11 @@ int main() {
                             cout << "\n\n\n\n\t\t\t\tPlease enter the input string: ";
                             cin.ignore();
                             getline(cin, inputString);
-                            delete TopDownParser;
                             delete lexer;
                             delete table;
                             table = new SymbolTable;
                             lexer = new Lexer(*table, inputString);
-                            TopDownParser = new LL1Parser(*lexer, path + inputGrammar);
+                            TopDownParser->reset(*lexer);
                             TopDownParser->parse();
                             loading();
                             break;
@@ -202,11 +245,13 @@ int main() {
                                 grammar_file.open(path + inputGrammar);
                             }
                             delete TopDownParser;
+                            delete TopDownGrammar;
                             delete lexer;
                             delete table;
                             table = new SymbolTable;
                             lexer = new Lexer(*table, inputString);
-                            TopDownParser = new LL1Parser(*lexer, path + inputGrammar);
+                            TopDownGrammar = new LL1Grammar(path + inputGrammar);
+                            TopDownParser = new LL1Parser(*TopDownGrammar, *lexer, true); // Trace every step for the processing table
                             TopDownParser->parse();
                             loading();
                             break;
@@ -237,6 +282,7 @@ int main() {
 
                         case 0:
                             delete TopDownParser;
+                            delete TopDownGrammar;
                             delete lexer;
                             delete table;
                             flag = false;
@@ -256,7 +302,8 @@ int main() {
                 flag = true;
                 table = new SymbolTable;
                 lexer = new Lexer(*table, inputString);
-                BottomUpParser1 = new LR1Parser(*lexer, path + inputGrammar);
+                BottomUpGrammar1 = new LR1Grammar(path + inputGrammar);
+                BottomUpParser1 = new LR1Parser(*BottomUpGrammar1, *lexer, true); // Trace every step for the processing table
                 BottomUpParser1->parse();
                 while (flag) {
                     switch (LR1Menu(*BottomUpParser1)) {
@@ -266,12 +313,11 @@ int main() {
                             cout << "\n\n\n\n\t\t\t\tPlease enter the input string: ";
                             cin.ignore();
                             getline(cin, inputString);
-                            delete BottomUpParser1;
                             delete lexer;
                             delete table;
                             table = new SymbolTable;
                             lexer = new Lexer(*table, inputString);
-                            BottomUpParser1 = new LR1Parser(*lexer, path + inputGrammar);
+                            BottomUpParser1->reset(*lexer);
                             BottomUpParser1->parse();
                             loading();
                             break;
@@ -300,11 +346,13 @@ int main() {
                                 grammar_file.open(path + inputGrammar);
                             }
                             delete BottomUpParser1;
+                            delete BottomUpGrammar1;
                             delete lexer;
                             delete table;
                             table = new SymbolTable;
                             lexer = new Lexer(*table, inputString);
-                            BottomUpParser1 = new LR1Parser(*lexer, path + inputGrammar);
+                            BottomUpGrammar1 = new LR1Grammar(path + inputGrammar);
+                            BottomUpParser1 = new LR1Parser(*BottomUpGrammar1, *lexer, true); // Trace every step for the processing table
                             BottomUpParser1->parse();
                             loading();
                             break;
@@ -341,6 +389,7 @@ int main() {
 
                         case 0:
                             delete BottomUpParser1;
+                            delete BottomUpGrammar1;
                             delete lexer;
                             delete table;
                             flag = false;
@@ -360,7 +409,8 @@ int main() {
                 flag = true;
                 table = new SymbolTable;
                 lexer = new Lexer(*table, inputString);
-                BottomUpParser2 = new LALR1Parser(*lexer, path + inputGrammar);
+                BottomUpGrammar2 = new LALR1Grammar(path + inputGrammar);
+                BottomUpParser2 = new LALR1Parser(*BottomUpGrammar2, *lexer, true); // Trace every step for the processing table
                 BottomUpParser2->parse();
                 while (flag) {
                     switch (LALR1Menu(*BottomUpParser2)) {
@@ -370,12 +420,11 @@ int main() {
                             cout << "\n\n\n\n\t\t\t\tPlease enter the input string: ";
                             cin.ignore();
                             getline(cin, inputString);
-                            delete BottomUpParser2;
                             delete lexer;
                             delete table;
                             table = new SymbolTable;
                             lexer = new Lexer(*table, inputString);
-                            BottomUpParser2 = new LALR1Parser(*lexer, path + inputGrammar);
+                            BottomUpParser2->reset(*lexer);
                             BottomUpParser2->parse();
                             loading();
                             break;
@@ -404,11 +453,13 @@ int main() {
                                 grammar_file.open(path + inputGrammar);
                             }
                             delete BottomUpParser2;
+                            delete BottomUpGrammar2;
                             delete lexer;
                             delete table;
                             table = new SymbolTable;
                             lexer = new Lexer(*table, inputString);
-                            BottomUpParser2 = new LALR1Parser(*lexer, path + inputGrammar);
+                            BottomUpGrammar2 = new LALR1Grammar(path + inputGrammar);
+                            BottomUpParser2 = new LALR1Parser(*BottomUpGrammar2, *lexer, true); // Trace every step for the processing table
                             BottomUpParser2->parse();
                             loading();
                             break;
@@ -445,6 +496,7 @@ int main() {
 
                         case 0:
                             delete BottomUpParser2;
+                            delete BottomUpGrammar2;
                             delete lexer;
                             delete table;
                             flag = false;
@@ -465,6 +517,87 @@ int main() {
                 break;
 
             case 6:
+                loading();
+                flag = true;
+                while (flag) {
+                    switch (BenchmarkMenu()) {
+                        case 1:
+                            loading();
+                            lexerBenchmark();
+                            loading();
+                            break;
+
+                        case 2: {
+                            loading();
+                            SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 11);
+                            cout << "\n\n\n\n\t\t\t\tPlease enter the source file path: ";
+                            cin.ignore();
+                            getline(cin, sourceFile);
+                            MappedFile *file = new MappedFile(sourceFile);
+                            if (!file->isOpen()) {
+                                delete file;
+                                system("cls");
+                                SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 12);
+                                cout << "\n\n\n\n\t\t\t\tError in opening source file!" << endl;
+                                Sleep(2000);
+                                break;
+                            }
+                            loading();
+                            fileLexerBenchmark(file); // The lexer takes ownership of the mapping
+                            loading();
+                            break;
+                        }
+
+                        case 3:
+                            loading();
+                            parseReplayBenchmark(inputString, path + inputGrammar);
+                            loading();
+                            break;
+
+                        case 4:
+                            loading();
+                            lexerScalingBenchmark();
+                            loading();
+                            break;
+
+                        case 5:
+                            loading();
+                            incrementalLexerBenchmark();
+                            loading();
+                            break;
+
+                        case 6:
+                            loading();
+                            grammarReaderBenchmark();
+                            loading();
+                            break;
+
+                        case 7:
+                            loading();
+                            grammarSetsBenchmark();
+                            loading();
+                            break;
+
+                        case 8:
+                            loading();
+                            parseTraceBenchmark(inputString, path + inputGrammar);
+                            loading();
+                            break;
+
+                        case 0:
+                            flag = false;
+                            loading();
+                            break;
+
+                        default:
+                            system("cls");
+                            cout << "\n\n\n\n\t\t\t\tPlease enter correct option!";
+                            Sleep(3000);
+                    }
+                }
+                break;
+
+            case 7:
                 SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 12);
                 system("cls");
                 cout << "\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\t\t\t\t\t\t\t\t\t\t\t\t*** Good Bye ***";
@@ -505,7 +638,8 @@ int Menu() {
     cout << " => Parsing Time: " << TimeLALR1 << " ns" << endl << endl;
     SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 7);
     cout << "\t\t\t\t[5] Calculate Parsing Times" << endl << endl;
-    cout << "\t\t\t\t[6] Exit" << endl << endl;
+    cout << "\t\t\t\t[6] Benchmarks" << endl << endl;
+    cout << "\t\t\t\t[7] Exit" << endl << endl;
     cout << "\t\t\t\t----------------------------------------------------------------------------------------" << endl << endl;
     cout << "\t\t\t\tPlease enter option : ";
     cin >> option;
@@ -513,66 +647,16 @@ int Menu() {
 }
 
 void time(string input, string grammar) {
-    SymbolTable *table;
-    Lexer *lexer;
-    RecursiveDescentParser *RDParser;
-    LL1Parser *TopDownParser;
-    LR1Parser *BottomUpParser1;
-    LALR1Parser *BottomUpParser2;
-    double time;
-
-    time = 0;
-    for (int i = 0; i < RUN; i++) {
-        table = new SymbolTable;
-        lexer = new Lexer(*table, input);
-        RDParser = new RecursiveDescentParser(*lexer, grammar);
-        RDParser->parse();
-        delete RDParser;
-        delete lexer;
-        delete table;
-        time += TimeRD;
-    }
-    TimeRD = time / RUN;
-
-    time = 0;
-    for (int i = 0; i < RUN; i++) {
-        table = new SymbolTable;
-        lexer = new Lexer(*table, input);
-        TopDownParser = new LL1Parser(*lexer, grammar);
-        TopDownParser->parse();
-        delete TopDownParser;
-        delete lexer;
-        delete table;
-        time += TimeLL1;
-    }
-    TimeLL1 = time / RUN;
-
-    time = 0;
-    for (int i = 0; i < RUN; i++) {
-        table = new SymbolTable;
-        lexer = new Lexer(*table, input);
-        BottomUpParser1 = new LR1Parser(*lexer, grammar);
-        BottomUpParser1->parse();
-        delete BottomUpParser1;
-        delete lexer;
-        delete table;
-        time += TimeLR1;
-    }
-    TimeLR1 = time / RUN;
-
-    time = 0;
-    for (int i = 0; i < RUN; i++) {
-        table = new SymbolTable;
-        lexer = new Lexer(*table, input);
-        BottomUpParser2 = new LALR1Parser(*lexer, grammar);
-        BottomUpParser2->parse();
-        delete BottomUpParser2;
-        delete lexer;
-        delete table;
-        time += TimeLALR1;
-    }
-    TimeLALR1 = time / RUN;
-
+    // Compile the grammar once for every parser, so only the parsing of the input is timed
+    RecursiveDescentGrammar RDGrammar(grammar);
+    LL1Grammar TopDownGrammar(grammar);
+    LR1Grammar BottomUpGrammar1(grammar);
+    LALR1Grammar BottomUpGrammar2(grammar);
+
+    TimeRD = averageParseTime<RecursiveDescentParser>(RDGrammar, input, NULL, TimeRD);
+    TimeLL1 = averageParseTime<LL1Parser>(TopDownGrammar, input, NULL, TimeLL1);
+    TimeLR1 = averageParseTime<LR1Parser>(BottomUpGrammar1, input, NULL, TimeLR1);
+    TimeLALR1 = averageParseTime<LALR1Parser>(BottomUpGrammar2, input, NULL, TimeLALR1);
 }
 
 void loading() {
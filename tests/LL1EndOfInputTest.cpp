@@ -0,0 +1,39 @@
+// Parses inputs that end while a non-terminal with no production on "$" is still on the LL(1) stack, which must be
+// rejected with a single end of input error instead of reading the end of input forever.
+// The project builds as a single translation unit, so the test includes main.cpp with its entry point renamed:
+// g++ -o LL1EndOfInputTest.exe tests/LL1EndOfInputTest.cpp -std=c++17
+#include <future>
+#define main compilerMain
+#include "../main.cpp"
+#undef main
+
+#define TEST_GRAMMAR "Grammars/g12.txt"
+#define TEST_TIMEOUT_SECONDS 5
+
+// Parse an input with the compiled grammar, reporting whether it ends in time, rejected with one end of input error
+bool rejectsAtEnd(const LL1Grammar &compiled, const string &input) {
+    SymbolTable table;
+    Lexer lexer(table, input);
+    LL1Parser *parser = new LL1Parser(compiled, lexer, true);
+    future<void> parsed = async(launch::async, [parser]() { parser->parse(); });
+    if (parsed.wait_for(chrono::seconds(TEST_TIMEOUT_SECONDS)) != future_status::ready) {
+        cout << "FAIL: '" << input << "' did not finish parsing" << endl;
+        exit(1); // The parse thread cannot be stopped
+    }
+    bool passed = !parser->accepted && parser->error_count == 1 && parser->errors[0].find("Unexpected end of input") != string::npos;
+    cout << (passed ? "PASS" : "FAIL") << ": '" << input << "', " << parser->error_count << " errors" << endl;
+    delete parser;
+    return passed;
+}
+
+int main() {
+    LL1Grammar compiled(TEST_GRAMMAR); // S -> ( L ) | id and L -> L + S | S
+    if (!compiled.valid || !compiled.ll1) {
+        cout << "FAIL: " << TEST_GRAMMAR << " did not compile to an LL(1) grammar" << endl;
+        return 1;
+    }
+    bool passed = rejectsAtEnd(compiled, "(");
+    passed &= rejectsAtEnd(compiled, "( id");
+    passed &= rejectsAtEnd(compiled, "( id + id");
+    return passed ? 0 : 1;
+}
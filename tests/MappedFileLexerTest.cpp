@@ -0,0 +1,58 @@
+// Lexes memory-mapped files that fill their last page exactly and end in an identifier, so no padding follows them.
+// The project builds as a single translation unit, so the test includes main.cpp with its entry point renamed:
+// g++ -o MappedFileLexerTest.exe tests/MappedFileLexerTest.cpp -std=c++17
+#define main compilerMain
+#include "../main.cpp"
+#undef main
+
+#define TEST_FILE "mapped_identifier_test.txt"
+
+// Lex a page-sized file of identifiers whose last identifier ends with the given text, reporting whether every token was found
+bool lexesPageEndingWith(const string &tail) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long long size = info.dwPageSize; // 4096 bytes on the usual page size
+
+    // Fill a whole page with identifiers separated by spaces, the last one running up to the final byte
+    string text;
+    while (text.length() + 8 + tail.length() < size)
+        text += "ident_1 ";
+    text += string(size - text.length() - tail.length(), 'x') + tail;
+    ofstream out(TEST_FILE, ios::binary);
+    out << text;
+    out.close();
+
+    MappedFile *file = new MappedFile(TEST_FILE);
+    if (!file->isOpen() || file->length != size || file->padding != 0) {
+        cout << "FAIL: the test file could not be mapped without padding" << endl;
+        delete file;
+        remove(TEST_FILE);
+        return false;
+    }
+
+    int expected = 1; // Identifiers written into the file
+    for (char c : text)
+        expected += c == ' ';
+
+    SymbolTable table;
+    Lexer *lexer = new Lexer(table, file); // The lexer takes ownership of the mapping
+    int count = 0; // Number of tokens before the end of the input
+    Token last, token;
+    while ((token = lexer->getNextToken()).kind != T_END) {
+        last = token;
+        count++;
+    }
+    delete lexer;
+    remove(TEST_FILE);
+
+    bool passed = count == expected && last.kind == T_ID && last.start + last.length == size;
+    cout << (passed ? "PASS" : "FAIL") << ": ending with '" << tail << "', " << count << " tokens, the last one ending at " << last.start + last.length << " of " << size << endl;
+    return passed;
+}
+
+int main() {
+    bool passed = lexesPageEndingWith("_end");
+    passed &= lexesPageEndingWith("_\xC3\xA9"); // The identifier ends with a non-ASCII letter
+    passed &= lexesPageEndingWith("\xC3\xA9t\xC3\xA9"); // The identifier starts and ends with a non-ASCII letter
+    return passed ? 0 : 1;
+}